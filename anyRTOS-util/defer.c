@@ -0,0 +1,148 @@
+
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * defer.c is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * defer.c is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "defer.h"
+#include "anyRTOS-conf.h"
+
+#if defined(ANYRTOS_USE_DEFER) && ANYRTOS_USE_DEFER
+
+#ifndef ANYRTOS_DEFER_QTY
+#define ANYRTOS_DEFER_QTY 8
+#warning "Defined ANYRTOS_DEFER_QTY 8"
+#endif
+
+#if ( ANYRTOS_DEFER_QTY & ( ANYRTOS_DEFER_QTY - 1 ) ) || ( ANYRTOS_DEFER_QTY > 256 )
+#error "ANYRTOS_DEFER_QTY must be a power of two up to 256."
+#endif
+
+/** Work item. A null function marks a free item. */
+typedef struct work_s {
+    deferFunc_t func;
+    void* param;
+} work_t;
+
+/** Pool of work items. */
+static work_t _pool[ANYRTOS_DEFER_QTY];
+
+/** Ring of the indexes of the pending work items in the order they were
+  * posted. The indexes run free. A work item is freed when it is got from the
+  * ring, so the ring never has more indexes than the pool has items. */
+static uint8_t _ring[ANYRTOS_DEFER_QTY];
+static unsigned int _head;
+static unsigned int _tail;
+
+/** The worker thread waits it when the ring is empty. */
+static event_t _event;
+
+/** Thread handler of the worker. */
+static thread_t _worker_th;
+
+/** Results of putting a work item. */
+typedef enum putCode_e {
+    _FULL,    /**< The pool is full. */
+    _DONE,    /**< It is put or it was pending. The worker is awake. */
+    _WAKE     /**< It is put in an empty ring. The worker may be waiting. */
+} putCode_t;
+
+/** Checks if the ring of pending work items is empty. */
+static bool _isEmpty( void ) { return _head == _tail; }
+
+/** Puts a work item unless it is pending. It must be called with the
+  * interrupts disabled.
+  * @param func: Function to be run by the worker thread.
+  * @param param: Parameter of the function.
+  * @return The result. */
+static putCode_t _put( deferFunc_t func, void* param ) {
+    work_t* spare = (work_t*)0;
+    for( unsigned int i = 0; i < ANYRTOS_DEFER_QTY; ++i ) {
+        work_t* work = &_pool[i];
+        if ( !work->func ) {
+            if ( !spare ) spare = work;
+        }
+        else if ( ( work->func == func ) && ( work->param == param ) )
+            return _DONE;
+    }
+    if ( !spare ) return _FULL;
+    spare->func = func;
+    spare->param = param;
+    bool const empty = _isEmpty();
+    _ring[ _head++ & ( ANYRTOS_DEFER_QTY - 1 ) ] = (uint8_t)( spare - _pool );
+    return empty? _WAKE: _DONE;
+}
+
+/** Gets the oldest work item and frees it. If it is posted again it runs
+  * again. It must be called with the interrupts disabled and the ring not
+  * empty.
+  * @return The work item copied. */
+static work_t _get( void ) {
+    work_t* work = &_pool[ _ring[ _tail++ & ( ANYRTOS_DEFER_QTY - 1 ) ] ];
+    work_t const copy = *work;
+    work->func = (deferFunc_t)0;
+    return copy;
+}
+
+/** Worker thread. It runs the work items with the interrupts enabled. */
+thread static void _worker_task( void* param ) {
+    (void)param;
+    for(;;) {
+        task_enterCritical();
+        while( _isEmpty() ) event_wait( &_event );
+        work_t const work = _get();
+        task_exitCritical();
+        work.func( work.param );
+    }
+}
+
+/* Starts the worker thread. */
+void defer_init( stack_t stack[], size_t size, prior_t prior ) {
+    for( unsigned int i = 0; i < ANYRTOS_DEFER_QTY; ++i )
+        _pool[i].func = (deferFunc_t)0;
+    _head = _tail = 0;
+    event_init( &_event );
+    threadInfo_t const info = {
+        .process = _worker_task,
+        .param = (void*)0,
+        .stack = stack,
+        .size = size,
+        .prior = prior,
+        .th = &_worker_th
+    };
+    scheduler_add( &info );
+}
+
+/* Posts a work item in an interrupt service routine. */
+queueCode_t defer_postISR( deferFunc_t func, void* param ) {
+    putCode_t const code = _put( func, param );
+    if ( code == _FULL ) return QUEUE_ERROR;
+    if ( ( code == _WAKE ) && event_notifyISR( &_event ) ) return QUEUE_DOYIELD;
+    return QUEUE_DONOTYIELD;
+}
+
+/* Posts a work item from a thread. */
+bool defer_post( deferFunc_t func, void* param ) {
+    task_enterCritical();
+    putCode_t const code = _put( func, param );
+    if ( code == _WAKE ) event_notify( &_event );
+    task_exitCritical();
+    return code != _FULL;
+}
+
+#endif /* ANYRTOS_USE_DEFER */
+
+/* ------------------------------------------------------------------------ */
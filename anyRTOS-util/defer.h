@@ -0,0 +1,76 @@
+
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * defer.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * defer.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _DEFER_
+#define _DEFER_
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "anyRTOS.h"
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup defer Deferred Work
+  * The interrupt service routines post work items and a worker thread runs
+  * them in the order they were posted with the interrupts enabled, so the
+  * routines only save the state of the device and leave the kernel work to
+  * the worker. A work item is a function and its parameter. The items are
+  * taken from a pool of ANYRTOS_DEFER_QTY, a power of 2 up to 256. A work
+  * item already pending is not taken twice, so an item posted many times
+  * before the worker gets it runs once. With fixed work items the pool never
+  * runs out if it has an item for each one. The posting never waits nor
+  * walks any list of threads and the worker only disables the interrupts to
+  * take an item.
+  * @{ */
+
+/** Function of a work item. */
+typedef void(*deferFunc_t)(void*);
+
+/** Starts the worker thread. It has to be called after scheduler_init().
+  * @param stack: Stack of the worker thread.
+  * @param size: Size in bytes of the stack.
+  * @param prior: Priority of the worker thread. */
+void defer_init( stack_t stack[], size_t size, prior_t prior );
+
+/** Posts a work item in an interrupt service routine.
+  * @param func: Function to be run by the worker thread.
+  * @param param: Parameter of the function.
+  * @retval QUEUE_ERROR: The pool is full.
+  * @retval QUEUE_DOYIELD: Success, yield is suggested.
+  * @retval QUEUE_DONOTYIELD: Success, no yield is suggested. */
+queueCode_t defer_postISR( deferFunc_t func, void* param );
+
+/** Posts a work item from a thread.
+  * @param func: Function to be run by the worker thread.
+  * @param param: Parameter of the function.
+  * @retval true: If success.
+  * @retval false: The pool is full. */
+bool defer_post( deferFunc_t func, void* param );
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _DEFER_ */
+
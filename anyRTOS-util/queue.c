@@ -17,6 +17,7 @@
  *
  */
 
+#include <string.h>
 #include "queue.h"
 #include "anyRTOS-conf.h"
 
@@ -63,16 +64,93 @@ static bool _put( queue_t* queue, uint8_t data ) {
     return true;
 }
 
+/** Gets the contiguous spans of memory of a number of bytes in a queue.
+  * @param queue: Queue handler.
+  * @param span: Destination of the two spans.
+  * @param index: Index of the first byte.
+  * @param size: Quantity of bytes.
+  * @return The quantity of bytes. */
+static size_t _spans( queue_t const* queue, queueSpan_t span[2], size_t index, size_t size ) {
+    size_t const tail = queue->size - index;
+    span[0].data = &queue->data[ index ];
+    span[0].size = ( size < tail )? size: tail;
+    span[1].data = queue->data;
+    span[1].size = size - span[0].size;
+    return size;
+}
+
+/** Gets the index of a queue that is a number of bytes after another one.
+  * @param queue: Queue handler.
+  * @param index: Index of the first byte.
+  * @param size: Quantity of bytes.
+  * @return The index. */
+static size_t _advance( queue_t const* queue, size_t index, size_t size ) {
+    index += size;
+    return ( index >= queue->size )? index - queue->size: index;
+}
+
+/** Gets the free room of a queue.
+  * @param queue: Queue handler.
+  * @return The quantity of free bytes. */
+static size_t _room( queue_t const* queue ) { return queue->size - queue->qty; }
+
+/** Limits a quantity of bytes to the size of a queue, so that waiting for it
+  * always ends.
+  * @param queue: Queue handler.
+  * @param size: Quantity of bytes.
+  * @return The quantity limited. */
+static size_t _fit( queue_t const* queue, size_t size ) {
+    return ( size < queue->size )? size: queue->size;
+}
+
+/** Puts in a queue a number of bytes already written after the last one.
+  * @param queue: Queue handler.
+  * @param size: Quantity of bytes. */
+static void _commit( queue_t* queue, size_t size ) {
+    queue->last = _advance( queue, queue->last, size );
+    queue->qty += size;
+}
+
+/** Puts as many bytes of a block of memory in a queue as fit. The bytes are
+  * copied in two contiguous spans at most.
+  * @param queue: Queue handler.
+  * @param src: Pointer to block of memory source.
+  * @param size: Size of block of memory.
+  * @return The quantity of bytes put. */
+static size_t _putBlock( queue_t* queue, uint8_t const* src, size_t size ) {
+    size_t const room = _room( queue );
+    if ( size > room ) size = room;
+    queueSpan_t span[2];
+    _spans( queue, span, queue->last, size );
+    memcpy( span[0].data, src, span[0].size );
+    memcpy( span[1].data, src + span[0].size, span[1].size );
+    _commit( queue, size );
+    return size;
+}
+
+/** Waits until put a block of memory in a queue. The getter is notified once
+  * each time the queue gets full and once at the end. It only waits when no
+  * byte could be put because the getter may have run while notifying.
+  * @param queue: Queue handler.
+  * @param src: Pointer to block of memory source.
+  * @param size: Size of block of memory. */
+static void _putAll( queue_t* queue, uint8_t const* src, size_t size ) {
+    for(;;) {
+        size_t const qty = _putBlock( queue, src, size );
+        src += qty;
+        size -= qty;
+        if ( !size ) break;
+        if ( qty ) event_notify( &queue->input );
+        else event_wait( &queue->output );
+    }
+    event_notify( &queue->input );
+}
+
 /* Waits until put a block of memory. */
 void queue_put( queue_t* queue, void const* src, size_t size ) {
     if ( !size ) return;
     mutex_enterCritical( &queue->putting );
-    for(;; ++src ) {
-        while ( !_put( queue, *(uint8_t*)src ) ) event_wait( &queue->output );
-        if ( !--size ) break;
-        if ( _isFull( queue ) ) event_notify( &queue->input );
-    }
-    event_notify( &queue->input );
+    _putAll( queue, src, size );
     mutex_exitCritical( &queue->putting );
 }
 
@@ -103,16 +181,53 @@ static bool _get( queue_t* queue, uint8_t* data ) {
     return true;
 }
 
+/** Removes from a queue a number of bytes already read from the first one.
+  * @param queue: Queue handler.
+  * @param size: Quantity of bytes. */
+static void _release( queue_t* queue, size_t size ) {
+    queue->first = _advance( queue, queue->first, size );
+    queue->qty -= size;
+}
+
+/** Gets as many bytes of a block of memory from a queue as available. The
+  * bytes are copied in two contiguous spans at most.
+  * @param queue: Queue handler.
+  * @param dst: Pointer to block of memory destination.
+  * @param size: Size of block of memory.
+  * @return The quantity of bytes got. */
+static size_t _getBlock( queue_t* queue, uint8_t* dst, size_t size ) {
+    if ( size > queue->qty ) size = queue->qty;
+    queueSpan_t span[2];
+    _spans( queue, span, queue->first, size );
+    memcpy( dst, span[0].data, span[0].size );
+    memcpy( dst + span[0].size, span[1].data, span[1].size );
+    _release( queue, size );
+    return size;
+}
+
+/** Waits until get a block of memory from a queue. The putter is notified
+  * once each time the queue gets empty and once at the end. It only waits
+  * when no byte could be got because the putter may have run while notifying.
+  * @param queue: Queue handler.
+  * @param dst: Pointer to block of memory destination.
+  * @param size: Size of block of memory. */
+static void _getAll( queue_t* queue, uint8_t* dst, size_t size ) {
+    for(;;) {
+        size_t const qty = _getBlock( queue, dst, size );
+        dst += qty;
+        size -= qty;
+        if ( !size ) break;
+        if ( qty ) event_notify( &queue->output );
+        else event_wait( &queue->input );
+    }
+    event_notify( &queue->output );
+}
+
 /* Waits until get a block of memory. */
 void queue_get( queue_t* queue, void* dst, size_t size ) {
     if ( !size ) return;
     mutex_enterCritical( &queue->getting );
-    for(;; ++dst ) {
-        while( !_get( queue, dst) ) event_wait( &queue->input );
-        if ( !--size ) break;
-        if ( _isEmpty( queue ) ) event_notify( &queue->output );
-    }
-    event_notify( &queue->output );
+    _getAll( queue, dst, size );
     mutex_exitCritical( &queue->getting );
 }
 
@@ -137,12 +252,7 @@ uint8_t queue_get8( queue_t* queue ) {
 /* Waits until put a null-terminated string. */
 void queue_putStr( queue_t* queue, char const* src ) {
     mutex_enterCritical( &queue->putting );
-    for(;; ++src ) {
-        while ( !_put( queue, *src ) ) event_wait( &queue->output );
-        if( !*src ) break;
-        if ( _isFull( queue ) ) event_notify( &queue->input );
-    }
-    event_notify( &queue->input );
+    _putAll( queue, (uint8_t const*)src, strlen( src ) + 1 );
     mutex_exitCritical( &queue->putting );
 }
 
@@ -163,16 +273,9 @@ bool queueTimer_get( queue_t* queue, timer_t* timer, void* dst, size_t size ) {
     if ( !size ) return true;
     if ( !mutexTimer_enterCritical( &queue->getting, timer ) ) return false;
     bool timeout = false;
-    while ( !timeout &&  !_get( queue, dst)  )
+    while ( !timeout && _isEmpty( queue ) )
         timeout = !eventTimer_wait( &queue->input, timer );
-    if ( !timeout ) {
-        if ( --size ) for( ++dst;; ++dst ) {
-            while ( !_get( queue, dst) ) event_wait( &queue->input );
-            if ( !--size ) break;
-            if ( _isEmpty( queue ) ) event_notify( &queue->output );
-        }
-        event_notify( &queue->output );
-    }
+    if ( !timeout ) _getAll( queue, dst, size );
     mutex_exitCritical( &queue->getting );
     return !timeout;
 }
@@ -182,16 +285,9 @@ bool queueTimer_put( queue_t* queue, timer_t* timer, void const* src, size_t siz
     if ( !size ) return true;
     if ( !mutexTimer_enterCritical( &queue->putting, timer ) ) return false;
     bool timeout = false;
-    while ( !timeout &&  !_put( queue, *(uint8_t*)src ) )
+    while ( !timeout && _isFull( queue ) )
         timeout = !eventTimer_wait( &queue->output, timer );
-    if ( !timeout ) {
-        if ( --size ) for( ++src;; ++src ) {
-            while ( !_put( queue, *(uint8_t*)src ) ) event_wait( &queue->output );
-            if ( !--size ) break;
-            if ( _isFull( queue ) ) event_notify( &queue->input );
-        }
-        event_notify( &queue->input );
-    }
+    if ( !timeout ) _putAll( queue, src, size );
     mutex_exitCritical( &queue->putting );
     return !timeout;
 }
@@ -204,7 +300,7 @@ bool queueTimer_put8( queue_t* queue, timer_t* timer, uint8_t data ) {
     while ( !timeout &&  !_put( queue, data ) )
         timeout = !eventTimer_wait( &queue->output, timer );
     if ( !timeout ) event_notify( &queue->input );
-    mutex_exitCritical( &queue->getting );
+    mutex_exitCritical( &queue->putting );
     return !timeout;
 }
 
@@ -225,16 +321,9 @@ bool queueTimer_putStr( queue_t* queue, timer_t* timer, char const* src ) {
     if ( !*src ) return true;
     if ( !mutexTimer_enterCritical( &queue->putting, timer ) ) return false;
     bool timeout = false;
-    while ( !timeout &&  !_put( queue, *src ) )
+    while ( !timeout && _isFull( queue ) )
         timeout = !eventTimer_wait( &queue->output, timer );
-    if ( !timeout ) {
-        if ( *src ) for( ++src;; ++src ) {
-            while ( !_put( queue, *src ) ) event_wait( &queue->output );
-            if( !*src ) break;
-            if ( _isFull( queue ) ) event_notify( &queue->input );
-        }
-        event_notify( &queue->input );
-    }
+    if ( !timeout ) _putAll( queue, (uint8_t const*)src, strlen( src ) + 1 );
     mutex_exitCritical( &queue->putting );
     return !timeout;
 }
@@ -281,6 +370,230 @@ queueCode_t queue_get8ThdISR( queue_t* queue, uint8_t* data, unsigned thd ) {
     return QUEUE_DONOTYIELD;
 }
 
+/* Gets a block of bytes in an interrupt service routine. Only an output event
+ * is generated when the data quantity in queue is less or equal than a 
+ * low-water mark. */
+queueCode_t queue_getBlockThdISR( queue_t* queue, void* dst, size_t size, size_t* qty, size_t thd ) {
+    *qty = _getBlock( queue, dst, size );
+    if ( !*qty ) return QUEUE_ERROR;
+    if ( (queue->qty <= thd) && event_notifyISR( &queue->output ) )
+        return QUEUE_DOYIELD;
+    return QUEUE_DONOTYIELD;
+}
+
+/* Waits until there is room for a number of bytes in a queue and gets the
+ * memory where they must be written. */
+void queue_reserve( queue_t* queue, queueSpan_t span[2], size_t size ) {
+    size = _fit( queue, size );
+    mutex_enterCritical( &queue->putting );
+    while( _room( queue ) < size ) event_wait( &queue->output );
+    _spans( queue, span, queue->last, size );
+    task_exitCritical();
+}
+
+/* Puts in a queue the bytes written in the memory got by queue_reserve(). */
+void queue_commit( queue_t* queue, size_t size ) {
+    task_enterCritical();
+    _commit( queue, size );
+    if ( size ) event_notify( &queue->input );
+    mutex_exitCritical( &queue->putting );
+}
+
+/* Waits until there are a number of bytes in a queue and gets the memory 
+ * where they can be read without removing them. */
+void queue_peek( queue_t* queue, queueSpan_t span[2], size_t size ) {
+    size = _fit( queue, size );
+    mutex_enterCritical( &queue->getting );
+    while( queue->qty < size ) event_wait( &queue->input );
+    _spans( queue, span, queue->first, size );
+    task_exitCritical();
+}
+
+/* Removes from a queue the bytes read in the memory got by queue_peek(). */
+void queue_release( queue_t* queue, size_t size ) {
+    task_enterCritical();
+    _release( queue, size );
+    if ( size ) event_notify( &queue->output );
+    mutex_exitCritical( &queue->getting );
+}
+
+/* Tries to reserve room for a number of bytes in a queue before a timeout. */
+bool queueTimer_reserve( queue_t* queue, timer_t* timer, queueSpan_t span[2], size_t size ) {
+    size = _fit( queue, size );
+    if ( !mutexTimer_enterCritical( &queue->putting, timer ) ) return false;
+    bool timeout = false;
+    while ( !timeout && ( _room( queue ) < size ) )
+        timeout = !eventTimer_wait( &queue->output, timer );
+    if ( timeout ) {
+        mutex_exitCritical( &queue->putting );
+        return false;
+    }
+    _spans( queue, span, queue->last, size );
+    task_exitCritical();
+    return true;
+}
+
+/* Tries to peek a number of bytes of a queue before a timeout. */
+bool queueTimer_peek( queue_t* queue, timer_t* timer, queueSpan_t span[2], size_t size ) {
+    size = _fit( queue, size );
+    if ( !mutexTimer_enterCritical( &queue->getting, timer ) ) return false;
+    bool timeout = false;
+    while ( !timeout && ( queue->qty < size ) )
+        timeout = !eventTimer_wait( &queue->input, timer );
+    if ( timeout ) {
+        mutex_exitCritical( &queue->getting );
+        return false;
+    }
+    _spans( queue, span, queue->first, size );
+    task_exitCritical();
+    return true;
+}
+
+/* Gets all the free room of a queue in an interrupt service routine. */
+size_t queue_reserveISR( queue_t* queue, queueSpan_t span[2] ) {
+    return _spans( queue, span, queue->last, _room( queue ) );
+}
+
+/* Puts in a queue the bytes written in the memory got by queue_reserveISR()
+ * in an interrupt service routine. */
+queueCode_t queue_commitISR( queue_t* queue, size_t size ) {
+    _commit( queue, size );
+    if ( size && event_notifyISR( &queue->input ) ) return QUEUE_DOYIELD;
+    return QUEUE_DONOTYIELD;
+}
+
+/* Gets all the bytes of a queue in an interrupt service routine without
+ * removing them. */
+size_t queue_peekISR( queue_t* queue, queueSpan_t span[2] ) {
+    return _spans( queue, span, queue->first, queue->qty );
+}
+
+/* Removes from a queue the bytes read in the memory got by queue_peekISR()
+ * in an interrupt service routine. */
+queueCode_t queue_releaseISR( queue_t* queue, size_t size ) {
+    _release( queue, size );
+    if ( size && event_notifyISR( &queue->output ) ) return QUEUE_DOYIELD;
+    return QUEUE_DONOTYIELD;
+}
+
+/* ------------------------------------------------------------------------ */
+/* ------------------------------------------------- Queue of Messages: --- */
+/* ------------------------------------------------------------------------ */
+
+/** Copies a message word by word if it is aligned or byte by byte if not.
+  * @param dst: Pointer to the message destination.
+  * @param src: Pointer to the message source.
+  * @param size: Size in bytes of the message. */
+static void _copyMsg( void* dst, void const* src, size_t size ) {
+    if ( ( (uintptr_t)dst | (uintptr_t)src | size ) % sizeof(unsigned int) ) {
+        uint8_t* d = dst;
+        uint8_t const* s = src;
+        while( size-- ) *d++ = *s++;
+        return;
+    }
+    unsigned int* d = dst;
+    unsigned int const* s = src;
+    for( size /= sizeof(unsigned int); size; --size ) *d++ = *s++;
+}
+
+/** Advances an index of a queue of messages a message.
+  * @param mq: Queue of messages handler.
+  * @param index: Index in bytes of a message.
+  * @return The index of the next message. */
+static size_t _nextMsg( msgQueue_t const* mq, size_t index ) {
+    index += mq->msgSize;
+    return ( index < mq->end )? index: (size_t)0;
+}
+
+/** Tries to put a message in a queue.
+  * @param mq: Queue of messages handler.
+  * @param msg: Pointer to the message source.
+  * @retval true If success;
+  * @retval false If queue was full. */
+static bool _putMsg( msgQueue_t* mq, void const* msg ) {
+    if ( mq->qty >= mq->max ) return false;
+    _copyMsg( &mq->data[ mq->last ], msg, mq->msgSize );
+    mq->last = _nextMsg( mq, mq->last );
+    ++mq->qty;
+    return true;
+}
+
+/** Tries to get a message from a queue.
+  * @param mq: Queue of messages handler.
+  * @param msg: Pointer to the message destination.
+  * @retval true If success;
+  * @retval false If queue was empty. */
+static bool _getMsg( msgQueue_t* mq, void* msg ) {
+    if ( !mq->qty ) return false;
+    _copyMsg( msg, &mq->data[ mq->first ], mq->msgSize );
+    mq->first = _nextMsg( mq, mq->first );
+    --mq->qty;
+    return true;
+}
+
+/* Initializes a queue of messages. */
+void msgQueue_init( msgQueue_t* mq, void* memory, size_t size, size_t msgSize ) {
+    event_init( &mq->input );
+    event_init( &mq->output );
+    mq->data = memory;
+    mq->msgSize = msgSize;
+    mq->max = msgSize? size / msgSize: (size_t)0;
+    mq->end = mq->max * msgSize;
+    mq->first = mq->last = mq->qty = (size_t)0;
+}
+
+/* Waits until put a message in a queue. */
+void msgQueue_put( msgQueue_t* mq, void const* msg ) {
+    task_enterCritical();
+    while( !_putMsg( mq, msg ) ) event_wait( &mq->output );
+    event_notify( &mq->input );
+    task_exitCritical();
+}
+
+/* Waits until get a message from a queue. */
+void msgQueue_get( msgQueue_t* mq, void* msg ) {
+    task_enterCritical();
+    while( !_getMsg( mq, msg ) ) event_wait( &mq->input );
+    event_notify( &mq->output );
+    task_exitCritical();
+}
+
+/* Tries to put a message in a queue before a timeout. */
+bool msgQueueTimer_put( msgQueue_t* mq, timer_t* timer, void const* msg ) {
+    task_enterCritical();
+    bool timeout = false;
+    while ( !timeout && !_putMsg( mq, msg ) )
+        timeout = !eventTimer_wait( &mq->output, timer );
+    if ( !timeout ) event_notify( &mq->input );
+    task_exitCritical();
+    return !timeout;
+}
+
+/* Tries to get a message from a queue before a timeout. */
+bool msgQueueTimer_get( msgQueue_t* mq, timer_t* timer, void* msg ) {
+    task_enterCritical();
+    bool timeout = false;
+    while ( !timeout && !_getMsg( mq, msg ) )
+        timeout = !eventTimer_wait( &mq->input, timer );
+    if ( !timeout ) event_notify( &mq->output );
+    task_exitCritical();
+    return !timeout;
+}
+
+/* Puts a message in an interrupt service routine. */
+queueCode_t msgQueue_putISR( msgQueue_t* mq, void const* msg ) {
+    if ( !_putMsg( mq, msg ) ) return QUEUE_ERROR;
+    if ( event_notifyISR( &mq->input ) ) return QUEUE_DOYIELD;
+    return QUEUE_DONOTYIELD;
+}
+
+/* Gets a message in an interrupt service routine. */
+queueCode_t msgQueue_getISR( msgQueue_t* mq, void* msg ) {
+    if ( !_getMsg( mq, msg ) ) return QUEUE_ERROR;
+    if ( event_notifyISR( &mq->output ) ) return QUEUE_DOYIELD;
+    return QUEUE_DONOTYIELD;
+}
+
 #endif /* ANYRTOS_USE_QUEUE */
 
 /* ------------------------------------------------------------------------ */
@@ -169,6 +169,181 @@ queueCode_t queue_get8ISR( queue_t* queue, uint8_t* data );
   * @retval QUEUE_DONOTYIELD: Success, no yield is suggested. */
 queueCode_t queue_get8ThdISR( queue_t* fifo, uint8_t* data, unsigned thd );
 
+/** Gets a block of bytes in an interrupt service routine. Drivers use it to
+  * refill a staging buffer, so the queue and its events are handled once 
+  * per block instead of once per byte. Only an output event is generated 
+  * when the data quantity in queue is less or equal than a low-water mark.
+  * @param queue: Queue handler.
+  * @param dst: Pointer to block of memory destination.
+  * @param size: Size of block of memory.
+  * @param qty: Destination of the quantity of bytes got.
+  * @param thd: Low-water mark to generate an output event.
+  * @retval QUEUE_ERROR: The queue is empty.
+  * @retval QUEUE_DOYIELD: Success, yield is suggested.
+  * @retval QUEUE_DONOTYIELD: Success, no yield is suggested. */
+queueCode_t queue_getBlockThdISR( queue_t* queue, void* dst, size_t size, size_t* qty, size_t thd );
+
+/** Contiguous span of memory inside a queue. */
+typedef struct queueSpan_s {
+    uint8_t* data;
+    size_t size;
+} queueSpan_t;
+
+/** Waits until there is room for a number of bytes in a queue and gets the
+  * memory where they must be written. The memory is split in two contiguous
+  * spans when the queue wraps, the second one may be empty. Other putters
+  * are blocked until queue_commit() is called.
+  * @param queue: Queue handler.
+  * @param span: Destination of the two spans.
+  * @param size: Quantity of bytes. If it is greater than the queue size, the
+  *              queue size is used and the spans get that quantity. */
+void queue_reserve( queue_t* queue, queueSpan_t span[2], size_t size );
+
+/** Puts in a queue the bytes written in the memory got by queue_reserve().
+  * @param queue: Queue handler.
+  * @param size: Quantity of bytes written. It must not be greater than the 
+  *              quantity reserved. */
+void queue_commit( queue_t* queue, size_t size );
+
+/** Waits until there are a number of bytes in a queue and gets the memory 
+  * where they can be read without removing them. The memory is split in two
+  * contiguous spans when the queue wraps, the second one may be empty. Other
+  * getters are blocked until queue_release() is called.
+  * @param queue: Queue handler.
+  * @param span: Destination of the two spans.
+  * @param size: Quantity of bytes. If it is greater than the queue size, the
+  *              queue size is used and the spans get that quantity. */
+void queue_peek( queue_t* queue, queueSpan_t span[2], size_t size );
+
+/** Removes from a queue the bytes read in the memory got by queue_peek().
+  * @param queue: Queue handler.
+  * @param size: Quantity of bytes read. It must not be greater than the 
+  *              quantity peeked. */
+void queue_release( queue_t* queue, size_t size );
+
+/** Tries to reserve room for a number of bytes in a queue before a timeout.
+  * queue_commit() must be called only if it success.
+  * @param queue: Queue handler.
+  * @param timer: Timer handler.
+  * @param span: Destination of the two spans.
+  * @param size: Quantity of bytes. If it is greater than the queue size, the
+  *              queue size is used and the spans get that quantity.
+  * @retval true:  The room is reserved before the timer gets the task tick.
+  * @retval false: The timer gets the task tick before the room is reserved. */
+bool queueTimer_reserve( queue_t* queue, timer_t* timer, queueSpan_t span[2], size_t size );
+
+/** Tries to peek a number of bytes of a queue before a timeout.
+  * queue_release() must be called only if it success.
+  * @param queue: Queue handler.
+  * @param timer: Timer handler.
+  * @param span: Destination of the two spans.
+  * @param size: Quantity of bytes. If it is greater than the queue size, the
+  *              queue size is used and the spans get that quantity.
+  * @retval true:  The bytes are peeked before the timer gets the task tick.
+  * @retval false: The timer gets the task tick before the bytes are peeked. */
+bool queueTimer_peek( queue_t* queue, timer_t* timer, queueSpan_t span[2], size_t size );
+
+/** Gets all the free room of a queue in an interrupt service routine.
+  * @param queue: Queue handler.
+  * @param span: Destination of the two spans.
+  * @return The quantity of free bytes. */
+size_t queue_reserveISR( queue_t* queue, queueSpan_t span[2] );
+
+/** Puts in a queue the bytes written in the memory got by queue_reserveISR()
+  * in an interrupt service routine.
+  * @param queue: Queue handler.
+  * @param size: Quantity of bytes written.
+  * @retval QUEUE_DOYIELD: Yield is suggested.
+  * @retval QUEUE_DONOTYIELD: No yield is suggested. */
+queueCode_t queue_commitISR( queue_t* queue, size_t size );
+
+/** Gets all the bytes of a queue in an interrupt service routine without
+  * removing them.
+  * @param queue: Queue handler.
+  * @param span: Destination of the two spans.
+  * @return The quantity of bytes. */
+size_t queue_peekISR( queue_t* queue, queueSpan_t span[2] );
+
+/** Removes from a queue the bytes read in the memory got by queue_peekISR()
+  * in an interrupt service routine.
+  * @param queue: Queue handler.
+  * @param size: Quantity of bytes read.
+  * @retval QUEUE_DOYIELD: Yield is suggested.
+  * @retval QUEUE_DONOTYIELD: No yield is suggested. */
+queueCode_t queue_releaseISR( queue_t* queue, size_t size );
+
+/** @} */
+
+/** @defgroup msg-queue Queue of Messages
+  * A queue of messages of a fixed size in a ring with two events. A message
+  * is put and got at once in a critical section, so messages of several
+  * putters are not interleaved and no mutex is needed. They are copied word
+  * by word if the memory, the messages and the message size are aligned to
+  * an unsigned int.
+  * @{ */
+
+/** Structure to handle queues of messages. */
+typedef struct msgQueue_s {
+    event_t input, output;
+    uint8_t* data;
+    size_t msgSize;         /**< Size in bytes of each message. */
+    size_t end;             /**< Size in bytes of the memory used. */
+    size_t first, last;     /**< Indexes in bytes of the ring. */
+    size_t max;             /**< Capacity in messages. */
+    size_t volatile qty;    /**< Quantity of messages. */
+} msgQueue_t;
+
+/** Initializes a queue of messages.
+  * @param mq: Queue of messages handler.
+  * @param memory: Pointer to memory space for queue.
+  * @param size: Size in bytes of memory space. Only a multiple of the 
+  *              message size is used.
+  * @param msgSize: Size in bytes of each message. It must not be zero, in
+  *                 that case the queue has no room for any message. */
+void msgQueue_init( msgQueue_t* mq, void* memory, size_t size, size_t msgSize );
+
+/** Waits until put a message in a queue.
+  * @param mq: Queue of messages handler.
+  * @param msg: Pointer to the message source. */
+void msgQueue_put( msgQueue_t* mq, void const* msg );
+
+/** Waits until get a message from a queue.
+  * @param mq: Queue of messages handler.
+  * @param msg: Pointer to the message destination. */
+void msgQueue_get( msgQueue_t* mq, void* msg );
+
+/** Tries to put a message in a queue before a timeout.
+  * @param mq: Queue of messages handler.
+  * @param timer: Timer handler.
+  * @param msg: Pointer to the message source.
+  * @retval true:  The message is put before the timer gets the task tick.
+  * @retval false: The timer gets the task tick before the message is put. */
+bool msgQueueTimer_put( msgQueue_t* mq, timer_t* timer, void const* msg );
+
+/** Tries to get a message from a queue before a timeout.
+  * @param mq: Queue of messages handler.
+  * @param timer: Timer handler.
+  * @param msg: Pointer to the message destination.
+  * @retval true:  The message is got before the timer gets the task tick.
+  * @retval false: The timer gets the task tick before the message is got. */
+bool msgQueueTimer_get( msgQueue_t* mq, timer_t* timer, void* msg );
+
+/** Puts a message in an interrupt service routine.
+  * @param mq: Queue of messages handler.
+  * @param msg: Pointer to the message source.
+  * @retval QUEUE_ERROR: The queue is full.
+  * @retval QUEUE_DOYIELD: Success, yield is suggested.
+  * @retval QUEUE_DONOTYIELD: Success, no yield is suggested. */
+queueCode_t msgQueue_putISR( msgQueue_t* mq, void const* msg );
+
+/** Gets a message in an interrupt service routine.
+  * @param mq: Queue of messages handler.
+  * @param msg: Pointer to the message destination.
+  * @retval QUEUE_ERROR: The queue is empty.
+  * @retval QUEUE_DOYIELD: Success, yield is suggested.
+  * @retval QUEUE_DONOTYIELD: Success, no yield is suggested. */
+queueCode_t msgQueue_getISR( msgQueue_t* mq, void* msg );
+
 /** @} */
 
 #ifdef __cplusplus
@@ -0,0 +1,155 @@
+
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * spsc.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * spsc.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _SPSC_
+#define _SPSC_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "anyRTOS.h"
+#include "queue.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup spsc Single Producer Single Consumer Ring
+  * A ring of bytes where an interrupt service routine puts and a single
+  * thread gets. The producer only writes the head and the consumer only
+  * writes the tail, so neither of them disables the interrupts to move
+  * bytes. The thread only enters in a critical section to wait when the
+  * ring is empty. The indexes run free and the size must be a power of 2.
+  * @{ */
+
+/** Structure to handle single producer single consumer rings. */
+typedef struct spsc_s {
+    event_t input;
+    size_t volatile head;
+    size_t volatile tail;
+    size_t mask;
+    uint8_t* data;
+} spsc_t;
+
+/** Initializes a ring.
+  * @param ring: Ring handler.
+  * @param memory: Pointer to memory space for ring.
+  * @param size: Size in bytes of memory space. It must be a power of 2. */
+static inline void spsc_init( spsc_t* ring, uint8_t memory[], size_t size ) {
+    event_init( &ring->input );
+    ring->head = ring->tail = (size_t)0;
+    ring->mask = size - 1;
+    ring->data = memory;
+}
+
+/** Checks if a ring is empty.
+  * @param ring: Ring handler.
+  * @retval true: If ring is empty;
+  * @retval false: If ring is not empty. */
+static inline bool spsc_isEmpty( spsc_t const* ring ) {
+    return ring->head == ring->tail;
+}
+
+/** Tries to put a byte in a ring. Only the producer can call it.
+  * @param ring: Ring handler.
+  * @param data: Byte to be put.
+  * @retval true If success;
+  * @retval false If ring was full. */
+static inline bool spsc_tryPut8( spsc_t* ring, uint8_t data ) {
+    size_t const head = ring->head;
+    if ( head - ring->tail > ring->mask ) return false;
+    ring->data[ head & ring->mask ] = data;
+    portable_barrier();
+    ring->head = head + 1;
+    return true;
+}
+
+/** Tries to get a byte from a ring. Only the consumer can call it.
+  * @param ring: Ring handler.
+  * @param data: Destination byte.
+  * @retval true If success;
+  * @retval false If ring was empty. */
+static inline bool spsc_tryGet8( spsc_t* ring, uint8_t* data ) {
+    size_t const tail = ring->tail;
+    if ( ring->head == tail ) return false;
+    portable_barrier();
+    *data = ring->data[ tail & ring->mask ];
+    portable_barrier();
+    ring->tail = tail + 1;
+    return true;
+}
+
+/** Puts a byte in an interrupt service routine. The consumer can only be
+  * waiting if the ring was empty, so only then it is notified.
+  * @param ring: Ring handler.
+  * @param data: Byte to be put.
+  * @retval QUEUE_ERROR: The ring is full.
+  * @retval QUEUE_DOYIELD: Success, yield is suggested.
+  * @retval QUEUE_DONOTYIELD: Success, no yield is suggested. */
+static inline queueCode_t spsc_put8ISR( spsc_t* ring, uint8_t data ) {
+    bool const wasEmpty = spsc_isEmpty( ring );
+    if ( !spsc_tryPut8( ring, data ) ) return QUEUE_ERROR;
+    if ( wasEmpty && event_notifyISR( &ring->input ) ) return QUEUE_DOYIELD;
+    return QUEUE_DONOTYIELD;
+}
+
+/** Notifies the consumer of a ring. It is for producers that put with
+  * spsc_tryPut8() and notify out of the interrupt service routine, for
+  * example with defer_postISR(). It is needed only if the ring was empty
+  * before the put.
+  * @param ring: Ring handler. */
+static inline void spsc_notify( spsc_t* ring ) {
+    event_notify( &ring->input );
+}
+
+/** Waits until get a byte from a ring.
+  * @param ring: Ring handler.
+  * @return The got byte. */
+static inline uint8_t spsc_get8( spsc_t* ring ) {
+    uint8_t data;
+    if ( spsc_tryGet8( ring, &data ) ) return data;
+    task_enterCritical();
+    while( !spsc_tryGet8( ring, &data ) ) event_wait( &ring->input );
+    task_exitCritical();
+    return data;
+}
+
+/** Tries to get a byte from a ring before a timeout.
+  * @param ring: Ring handler.
+  * @param timer: Timer handler.
+  * @param data: Destination byte.
+  * @retval true:  The byte is got before the timer gets the task tick.
+  * @retval false: The timer gets the task tick before the byte is got. */
+static inline bool spscTimer_get8( spsc_t* ring, timer_t* timer, uint8_t* data ) {
+    if ( spsc_tryGet8( ring, data ) ) return true;
+    task_enterCritical();
+    bool timeout = false;
+    while( !timeout && !spsc_tryGet8( ring, data ) )
+        timeout = !eventTimer_wait( &ring->input, timer );
+    task_exitCritical();
+    return !timeout;
+}
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _SPSC_ */
+
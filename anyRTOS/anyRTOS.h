@@ -26,6 +26,11 @@
 #include "timer.h"
 #include "mutex.h"
 #include "sem.h"
+#include "csem.h"
+#include "flags.h"
+#include "trace.h"
+#include "idle.h"
+#include "latency.h"
 
 #endif	/* _ANY_RTOS_ */
 
@@ -0,0 +1,117 @@
+
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * csem.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * csem.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _CSEM_
+#define	_CSEM_
+
+#include <stdbool.h>
+#include "anyRTOS-conf.h"
+#include "timer.h"
+#include "src/thread-list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup counting-semaphore Counting Semaphore
+  * A counting semaphore handles a pool of units. Threads take and give
+  * several units at once. The waiting threads are served in priority order
+  * and a thread does not overtake a higher priority one that is waiting more
+  * units than available. Threads of the same priority are served first come,
+  * first served. When units are given, they are handed to the waiting
+  * threads in that order until the units of the next one are not available,
+  * so only the threads that get their units are resumed. A thread that stops
+  * waiting by timeout hands the units it has kept back in the same way.
+  * @{ */
+
+/** Structure to handle counting semaphores. */
+typedef struct csem_s {
+    priorList_t list;
+    unsigned int volatile units;
+} csem_t;
+
+/** Initializes a counting semaphore.
+  * @param csem: Counting semaphore handler.
+  * @param units: Initial units quantity. */
+void csem_init( csem_t* csem, unsigned int units );
+
+/** Gets the units that are available in a counting semaphore.
+  * @param csem: Counting semaphore handler.
+  * @return The units quantity. */
+static inline unsigned int csem_units( csem_t const* csem ) { return csem->units; }
+
+/** Waits until a number of units are available and takes them.
+  * @param csem: Counting semaphore handler.
+  * @param units: Units quantity. */
+void csem_take( csem_t* csem, unsigned int units );
+
+/** Takes a number of units if they are available without waiting.
+  * @param csem: Counting semaphore handler.
+  * @param units: Units quantity.
+  * @retval true: If the units were taken.
+  * @retval false: If the units are not available. */
+bool csem_tryTake( csem_t* csem, unsigned int units );
+
+/** Gives a number of units to a counting semaphore.
+  * @param csem: Counting semaphore handler.
+  * @param units: Units quantity. */
+void csem_give( csem_t* csem, unsigned int units );
+
+/** Gives a number of units to a counting semaphore in an interrupt service
+  * routine. It does not yield.
+  * @param csem: Counting semaphore handler.
+  * @param units: Units quantity.
+  * @retval true: If yield is suggested.
+  * @retval false: If yield is not necessary. */
+bool csem_giveISR( csem_t* csem, unsigned int units );
+
+#if !defined( ANYRTOS_BASIC_MODE ) || ( !ANYRTOS_BASIC_MODE )
+
+/** Waits until a number of units are available and takes them or until the
+  * tick counter of a timer gets the task tick.
+  * @param csem: Counting semaphore handler.
+  * @param timer: Timer handler.
+  * @param units: Units quantity.
+  * @retval true:  The units are taken before the timer gets the task tick.
+  * @retval false: The timer gets the task tick before the units are taken. */
+bool csemTimer_take( csem_t* csem, timer_t* timer, unsigned int units );
+
+#else
+
+/** Waits until a number of units are available and takes them.
+  * @param csem: Counting semaphore handler.
+  * @param timer: Timer handler, ignored.
+  * @param units: Units quantity.
+  * @return It always returns true. */
+static inline bool csemTimer_take( csem_t* csem, timer_t* timer, unsigned int units ) {
+    (void)timer;
+    csem_take( csem, units );
+    return true;
+}
+
+#endif /* ANYRTOS_BASIC_MODE */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* _CSEM_ */
+
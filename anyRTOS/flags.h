@@ -0,0 +1,126 @@
+
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * flags.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * flags.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _FLAGS_
+#define	_FLAGS_
+
+#include <stdbool.h>
+#include "anyRTOS-conf.h"
+#include "timer.h"
+#include "src/thread-list.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup flags Event Flag Group
+  * An event flag group is a mask of bits that threads and interrupt service
+  * routines set and clear. A thread waits until any or all bits of a mask are
+  * set. When the bits are set every waiting thread whose condition is
+  * satisfied is resumed in a single pass.
+  * @{ */
+
+/** Wait modes. They can be combined with the or operator. */
+enum {
+    FLAGS_ANY   = 0, /**< Waits until any bit of the mask is set.  */
+    FLAGS_ALL   = 1, /**< Waits until all bits of the mask are set. */
+    FLAGS_CLEAR = 2  /**< Clears the bits of the mask when the wait ends. */
+};
+
+/** Structure to handle event flag groups. */
+typedef struct flags_s {
+    priorList_t list;
+    unsigned int volatile value;
+} flags_t;
+
+/** Initializes an event flag group.
+  * @param flags: Event flag group handler.
+  * @param value: Initial bits. */
+void flags_init( flags_t* flags, unsigned int value );
+
+/** Gets the bits of an event flag group.
+  * @param flags: Event flag group handler.
+  * @return The bits that are set. */
+static inline unsigned int flags_get( flags_t const* flags ) { return flags->value; }
+
+/** Sets the running thread in blocked state until the bits of a mask are set.
+  * @param flags: Event flag group handler.
+  * @param mask: Bits to wait.
+  * @param mode: FLAGS_ANY or FLAGS_ALL, optionally with FLAGS_CLEAR.
+  * @return The bits of the mask that were set when the wait ended. With an
+  *         empty mask it does not wait and returns zero. */
+unsigned int flags_wait( flags_t* flags, unsigned int mask, uint8_t mode );
+
+/** Sets bits of an event flag group and resumes every thread whose condition
+  * is satisfied. If the priority of one of them is higher than the running
+  * thread it yields.
+  * @param flags: Event flag group handler.
+  * @param mask: Bits to set. */
+void flags_set( flags_t* flags, unsigned int mask );
+
+/** Sets bits of an event flag group and resumes every thread whose condition
+  * is satisfied in an interrupt service routine. It does not yield.
+  * @param flags: Event flag group handler.
+  * @param mask: Bits to set.
+  * @retval true: If the priority of a resumed thread is higher than the
+  *               running thread.
+  * @retval false: In other case.*/
+bool flags_setISR( flags_t* flags, unsigned int mask );
+
+/** Clears bits of an event flag group.
+  * @param flags: Event flag group handler.
+  * @param mask: Bits to clear. */
+void flags_clear( flags_t* flags, unsigned int mask );
+
+#if !defined( ANYRTOS_BASIC_MODE ) || ( !ANYRTOS_BASIC_MODE )
+
+/** Waits until the bits of a mask are set or until the tick counter of a
+  * timer gets the task tick.
+  * @param flags: Event flag group handler.
+  * @param timer: Timer handler.
+  * @param mask: Bits to wait.
+  * @param mode: FLAGS_ANY or FLAGS_ALL, optionally with FLAGS_CLEAR.
+  * @return The bits of the mask that were set when the wait ended or zero
+  *         if the timer gets the task tick before or the mask is empty. */
+unsigned int flagsTimer_wait( flags_t* flags, timer_t* timer, unsigned int mask, uint8_t mode );
+
+#else
+
+/** Sets the running thread in blocked state until the bits of a mask are set.
+  * @param flags: Event flag group handler.
+  * @param timer: Timer handler, ignored.
+  * @param mask: Bits to wait.
+  * @param mode: FLAGS_ANY or FLAGS_ALL, optionally with FLAGS_CLEAR.
+  * @return The bits of the mask that were set when the wait ended. With an
+  *         empty mask it does not wait and returns zero. */
+static inline unsigned int flagsTimer_wait( flags_t* flags, timer_t* timer, unsigned int mask, uint8_t mode ) {
+    (void)timer;
+    return flags_wait( flags, mask, mode );
+}
+
+#endif /* ANYRTOS_BASIC_MODE */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif	/* _FLAGS_ */
+
@@ -0,0 +1,80 @@
+
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * idle.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * idle.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _IDLE_
+#define _IDLE_
+
+#include <stdint.h>
+#include "anyRTOS-conf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup idle Idle Control
+  * The background thread is the code after scheduler_run() and it only runs
+  * when every thread is blocked. It has to call idle_run() in a loop.
+  *
+  * With ANYRTOS_IDLE_LOAD set to a number of windows the CPU load is measured
+  * in windows closed by idle_window(). Without ANYRTOS_IDLE_LPM each pass of
+  * idle_run() is counted and compared with a reference, the most passes in a
+  * window unless idle_setReference() fixes it. With ANYRTOS_IDLE_LPM the
+  * background thread sleeps, so the time it holds the CPU is measured with
+  * trace_stamp() and compared with the length of the window. Then the timer
+  * driver has to provide trace_stamp() and ANYRTOS_STAMP has to be set.
+  * @{ */
+
+/** Runs a pass of the background thread. It counts the pass for the CPU
+  * load and calls idle_hook(). */
+void idle_run( void );
+
+/** Does the work of the background thread. By default it enters in low power
+  * mode with ANYRTOS_IDLE_LPM and it does nothing in other case. The
+  * application can define other one. */
+void idle_hook( void );
+
+#if defined(ANYRTOS_IDLE_LOAD) && ANYRTOS_IDLE_LOAD
+
+/** Closes a window of the CPU load and starts the next one. It has to be
+  * called periodically.*/
+void idle_window( void );
+
+/** Closes a window of the CPU load in an interrupt service routine. */
+void idle_windowISR( void );
+
+/** Gets the average CPU load of the last windows.
+  * @param windows: Number of windows, up to ANYRTOS_IDLE_LOAD.
+  * @return The load in tenths of percent, from 0 to 1000. */
+unsigned int idle_load( unsigned int windows );
+
+/** Sets the passes of idle_run() in a window without load. With 0 it is the
+  * most passes counted in a window. It is ignored with ANYRTOS_IDLE_LPM.
+  * @param passes: Reference passes. */
+void idle_setReference( uint32_t passes );
+
+#endif /* ANYRTOS_IDLE_LOAD */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _IDLE_ */
+
@@ -0,0 +1,106 @@
+
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * latency.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * latency.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _LATENCY_
+#define _LATENCY_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "anyRTOS-conf.h"
+#include "timer.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup latency Latency Meter
+  * With ANYRTOS_LATENCY set to a number of call sites the kernel measures how
+  * long the interrupts stay disabled by critical sections. The site of a
+  * measure is the return address of the function that entered the outermost
+  * critical section, so it points to the code that called the kernel. The
+  * time is counted with trace_stamp(), so the timer driver has to provide it
+  * and ANYRTOS_STAMP has to be set. Without a stamp source every duration
+  * would be zero and no jitter would be reported, so it is not compiled. The
+  * interrupt service routines are not measured.
+  *
+  * jitter_period() waits as timer_period() and measures the period and the
+  * latency from the timer expiry until the thread runs again.
+  * @{ */
+
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+
+/** Number of buckets of the histograms. The bucket n counts the durations
+  * with n significant bits and the last one counts the longer ones too. */
+enum { LATENCY_BUCKETS = 12 };
+
+/** Measures of a site that disables the interrupts. */
+typedef struct latencySite_s {
+    void const* site;   /**< Return address of the site. NULL for the rest of
+                             sites when the table is full. */
+    uint32_t count;     /**< Number of measures. */
+    uint32_t max;       /**< Longest duration. */
+    uint16_t hist[LATENCY_BUCKETS]; /**< Histogram of durations. */
+} latencySite_t;
+
+/** Copies the measures of the sites that have disabled the interrupts.
+  * @param dst: Destination array.
+  * @param qty: Length of destination array.
+  * @return The number of sites copied. */
+size_t latency_read( latencySite_t dst[], size_t qty );
+
+/** Clears the measures of all sites. */
+void latency_reset( void );
+
+/** Measures of a periodic thread. */
+typedef struct jitter_s {
+    uint32_t last;       /**< Stamp of the last release. */
+    uint32_t count;      /**< Number of releases measured. */
+    uint32_t minPeriod;  /**< Shortest period between releases. */
+    uint32_t maxPeriod;  /**< Longest period between releases. */
+    uint32_t maxLatency; /**< Longest time from the timer expiry to running. */
+} jitter_t;
+
+/** Initializes the measures of a periodic thread.
+  * @param jitter: Jitter handler. */
+void jitter_init( jitter_t* jitter );
+
+/** Waits N ticks of a timer from the task tick as timer_period() and
+  * measures the release of the running thread.
+  * @param jitter: Jitter handler.
+  * @param timer: The timer handler.
+  * @param ticks: Ticks quantity to wait. */
+void jitter_period( jitter_t* jitter, timer_t* timer, tick_t ticks );
+
+/** Gets the jitter of the period of a thread.
+  * @param jitter: Jitter handler.
+  * @return The difference between the longest and the shortest periods. */
+static inline uint32_t jitter_get( jitter_t const* jitter ) {
+    return ( jitter->count > 1 )? jitter->maxPeriod - jitter->minPeriod: 0;
+}
+
+#endif /* ANYRTOS_LATENCY */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _LATENCY_ */
+
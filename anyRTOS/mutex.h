@@ -32,10 +32,15 @@ extern "C" {
 /** @defgroup mutex Mutual Exclusion Control
   * @{ */ 
 
-/** Structure to handle mutual exclusion sections. */
+/** Structure to handle mutual exclusion sections. With 
+  * ANYRTOS_USE_INHERITANCE the owner of a mutex inherits the priority of the
+  * highest priority thread that is waiting it. */
 typedef struct mutex_s {    
     priorList_t list;
     thread_t* volatile busy;
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+    struct mutex_s* next;   /**< Previous mutex entered by the owner. */
+#endif
 } mutex_t;
 
 /** Initializes a mutual exclusion handle.
@@ -22,6 +22,7 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include "timer.h"
 #include "src/thread-list.h"
 
 #ifdef __cplusplus
@@ -50,6 +51,69 @@ void scheduler_add( threadInfo_t const* info );
 /** Starts the scheduler. */
 void scheduler_run( void );
 
+#if defined(ANYRTOS_TIME_SLICE) && ANYRTOS_TIME_SLICE
+
+/** Sets the quantum of a thread. With ANYRTOS_TIME_SLICE set to a number of
+  * ticks each thread gets that quantum when it is added. When the running
+  * thread has got a quantum of timer_tick() calls, timer_tick() suggests to
+  * yield if other thread of the same priority is ready, so the running one
+  * goes to the end of the queue of its priority. A new quantum starts each
+  * time a thread gets the CPU. The ticks of timer_advance() do not count and
+  * only the ticks of the slice timer count. scheduler_add() sets the quantum
+  * of ANYRTOS_TIME_SLICE, so this function has to be called after it.
+  * @param th: Thread handler.
+  * @param ticks: Ticks of the quantum. 0 disables the slicing of the thread. */
+void scheduler_setSlice( thread_t* th, tick_t ticks );
+
+/** Sets the timer whose timer_tick() calls count in the quanta. The ticks of
+  * other timers do not count. By default it is the first timer ticked.
+  * @param timer: Timer handler. */
+void scheduler_setSliceTimer( timer_t const* timer );
+
+#endif /* ANYRTOS_TIME_SLICE */
+
+#if defined(ANYRTOS_STATS) && ANYRTOS_STATS
+
+/** Accounting of a thread. The time is counted with trace_stamp(). */
+typedef struct threadStats_s {
+    thread_t const* th;    /**< Thread handler. */
+    prior_t prior;         /**< Current priority of thread. */
+    uint32_t runTime;      /**< Time that the thread has been running. */
+    uint32_t voluntary;    /**< Times it left the CPU to wait or yield. */
+    uint32_t involuntary;  /**< Times it was preempted. */
+    uint32_t wakeups;      /**< Times it was set in ready state. */
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+    size_t stackUnused;    /**< Bytes of its stack never used. */
+#endif
+} threadStats_t;
+
+/** Copies the accounting of the threads in a single critical section. The
+  * first one is the background thread and the rest are in the order they were
+  * added to the scheduler.
+  * @param dst: Destination array.
+  * @param qty: Length of destination array.
+  * @return The number of threads copied. */
+size_t scheduler_stats( threadStats_t dst[], size_t qty );
+
+#endif /* ANYRTOS_STATS */
+
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+
+/** Gets the bytes of the stack of a thread that have never been used. The
+  * stacks are painted by scheduler_add(), so the background thread gets 0.
+  * @param th: Thread handler.
+  * @return The unused bytes from the lowest address of the stack. */
+size_t scheduler_stackUnused( thread_t const* th );
+
+/** Handles a stack overflow. With ANYRTOS_STACK_CHECK 2 the lowest word of the
+  * stack of the running thread is checked in each context switch and this
+  * function is called if it has been overwritten. The default one disables
+  * the interrupts and loops forever. The application can define other one.
+  * @param th: Handler of the thread that has overflowed its stack. */
+void scheduler_stackOverflow( thread_t* th );
+
+#endif /* ANYRTOS_STACK_CHECK */
+
 /** @} */             
 
 #ifdef __cplusplus
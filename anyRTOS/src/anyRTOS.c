@@ -46,38 +46,381 @@ static thread_t *volatile _running = &_background;
 /** Array of lists by priority of ready threads. */
 static threadQueue_t _ready[REALY_PRIOR_QTY];
 
+/** Map of the priorities that have ready threads. */
+static priorMap_t _readyMap;
+
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+
+/** Programs the next interrupt of a timer driven in tickless mode.
+  * @param timer: Timer handler. */
+static void _reloadTimer( timer_t const* timer ) { timer_reload( timer ); }
+
+#else
+
+/** A periodic timer has not to be programmed.
+  * @param timer: Timer handler. */
+static void _reloadTimer( timer_t const* timer ) { (void)timer; }
+
+#endif /* ANYRTOS_TICKLESS */
+
+#if !( defined(ANYRTOS_STAMP) && ANYRTOS_STAMP )
+
+#if defined(ANYRTOS_STATS) && ANYRTOS_STATS
+#error "ANYRTOS_STATS needs a stamp source, see ANYRTOS_STAMP."
+#endif
+
+#if ( defined(ANYRTOS_IDLE_LOAD) && ANYRTOS_IDLE_LOAD ) \
+ && ( defined(ANYRTOS_IDLE_LPM) && ANYRTOS_IDLE_LPM )
+#error "ANYRTOS_IDLE_LOAD with ANYRTOS_IDLE_LPM needs a stamp source, see ANYRTOS_STAMP."
+#endif
+
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+#error "ANYRTOS_LATENCY needs a stamp source, see ANYRTOS_STAMP."
+#endif
+
+#if defined(ANYRTOS_TRACE) && ANYRTOS_TRACE
+#warning "Without ANYRTOS_STAMP the trace only records the order of the events."
+#endif
+
+#endif /* ANYRTOS_STAMP */
+
+#if defined(ANYRTOS_TRACE) && ANYRTOS_TRACE
+
+#if ANYRTOS_TRACE & ( ANYRTOS_TRACE - 1 )
+#error "ANYRTOS_TRACE must be a power of 2."
+#endif
+
+/** Ring of trace events. */
+static traceEvent_t _trace[ ANYRTOS_TRACE ];
+
+/** Index of the next trace event. */
+static unsigned int _traceIndex;
+
+/** Quantity of trace events in the ring. */
+static unsigned int _traceQty;
+
+/** Records a trace event. It must be called in a critical section or ISR.
+  * @param kind: Kind of event.
+  * @param arg: Reason, source or ISR identifier.
+  * @param th: Thread handler. */
+static void _traceEvent( uint8_t kind, uint8_t arg, thread_t const* th ) {
+    traceEvent_t* ev = &_trace[ _traceIndex ];
+    _traceIndex = ( _traceIndex + 1 ) & ( ANYRTOS_TRACE - 1 );
+    if ( _traceQty < ANYRTOS_TRACE ) ++_traceQty;
+    ev->stamp = trace_stamp();
+    ev->th = (uint16_t)(uintptr_t)th;
+    ev->kind = kind;
+    ev->arg = arg;
+}
+
+#else
+
+/** Without trace nothing is recorded. */
+static void _traceEvent( uint8_t kind, uint8_t arg, thread_t const* th ) {
+    (void)kind;
+    (void)arg;
+    (void)th;
+}
+
+#endif /* ANYRTOS_TRACE */
+
+#if defined(ANYRTOS_STATS) && ANYRTOS_STATS
+
+/** Last thread added to the scheduler. The list starts in background thread. */
+static thread_t* _statsLast;
+
+/** Value of trace_stamp() in the last context switch. */
+static uint32_t _switchStamp;
+
+/** Starts the list of threads and the run time counting. */
+static void _initStats( void ) {
+    _statsLast = &_background;
+    _switchStamp = trace_stamp();
+}
+
+/** Appends a thread to the list of threads added to the scheduler.
+  * @param th: Thread handler. */
+static void _addStats( thread_t* th ) {
+    _statsLast->nextSt = th;
+    _statsLast = th;
+}
+
+/** Accounts the run time of the running thread and its switch.
+  * @param th: Thread that gets the CPU.
+  * @param reason: Reason why the running thread leaves the CPU. */
+static void _countSwitch( thread_t const* th, uint8_t reason ) {
+    uint32_t const now = trace_stamp();
+    _running->runTime += now - _switchStamp;
+    _switchStamp = now;
+    if ( th == _running ) return;
+    if ( reason == TRACE_READY ) ++_running->involuntary;
+    else ++_running->voluntary;
+}
+
+/** Accounts a wakeup of a thread.
+  * @param th: Thread handler. */
+static void _countWakeup( thread_t* th ) { ++th->wakeups; }
+
+#else
+
+/** Without statistics nothing is accounted. */
+static void _initStats( void ) { }
+static void _addStats( thread_t* th ) { (void)th; }
+static void _countSwitch( thread_t const* th, uint8_t reason ) {
+    (void)th;
+    (void)reason;
+}
+static void _countWakeup( thread_t* th ) { (void)th; }
+
+#endif /* ANYRTOS_STATS */
+
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+
+/** Pattern painted in the stacks. The words that keep it were never used. */
+#define STACK_PAINT ( (stack_t)0xA5A5A5A5A5A5A5A5ull )
+
+/** Paints the stack of a new thread. It must be called before initializing
+  * its context.
+  * @param info: Information of the thread. */
+static void _paintStack( threadInfo_t const* info ) {
+    thread_t* th = info->th;
+    th->stack = info->stack;
+    th->stackQty = info->size / sizeof(stack_t);
+    for( size_t i = 0; i < th->stackQty; ++i ) th->stack[i] = STACK_PAINT;
+}
+
+#else
+
+/** Without stack check the stacks are not painted. */
+static void _paintStack( threadInfo_t const* info ) { (void)info; }
+
+#endif /* ANYRTOS_STACK_CHECK */
+
+#if defined(ANYRTOS_STACK_CHECK) && ( ANYRTOS_STACK_CHECK > 1 )
+
+/** Checks the canary of a thread, the lowest word of its stack. If it has
+  * been overwritten scheduler_stackOverflow() is called.
+  * @param th: Thread handler. */
+static void _checkStack( thread_t* th ) {
+    if ( th->stack && ( th->stack[0] != STACK_PAINT ) ) scheduler_stackOverflow( th );
+}
+
+#else
+
+/** Without canary check nothing is checked. */
+static void _checkStack( thread_t* th ) { (void)th; }
+
+#endif /* ANYRTOS_STACK_CHECK */
+
+#if defined(ANYRTOS_TIME_SLICE) && ANYRTOS_TIME_SLICE
+
+/** Timer whose ticks count in the quanta. */
+static timer_t const* _sliceTimer;
+
+/** Starts a new quantum for a thread that gets the CPU.
+  * @param th: Thread handler. */
+static void _startSlice( thread_t* th ) { th->sliceLeft = th->slice; }
+
+/** Counts a tick in the quantum of the running thread. When it is over a new
+  * one starts, so the running thread goes on if no other thread of its
+  * priority is ready. Only the ticks of the slice timer count. If it has not
+  * been set the first timer ticked is the slice timer.
+  * @param timer: The timer ticked.
+  * @retval true: If the quantum is over and other thread of the same 
+  *               priority is ready.
+  * @retval false: In other case. */
+static bool _countSlice( timer_t const* timer ) {
+    if ( !_sliceTimer ) _sliceTimer = timer;
+    if ( timer != _sliceTimer ) return false;
+    thread_t* th = _running;
+    if ( !th->slice || --th->sliceLeft ) return false;
+    th->sliceLeft = th->slice;
+    return !threadQueue_isEmpty( &_ready[th->prior] );
+}
+
+#else
+
+/** Without time slicing the threads run until they yield or get blocked. */
+static void _startSlice( thread_t* th ) { (void)th; }
+static bool _countSlice( timer_t const* timer ) { (void)timer; return false; }
+
+#endif /* ANYRTOS_TIME_SLICE */
+
+#if defined(ANYRTOS_IDLE_LOAD) && ANYRTOS_IDLE_LOAD && defined(ANYRTOS_IDLE_LPM) && ANYRTOS_IDLE_LPM
+
+/** Time that the background thread has held the CPU in the current window. */
+static uint32_t _idleTime;
+
+/** Value of trace_stamp() when the background thread got the CPU. */
+static uint32_t _idleStart;
+
+/** Value of trace_stamp() when the current window started. */
+static uint32_t _windowStart;
+
+/** Starts the first window of CPU load. */
+static void _initIdle( void ) {
+    _idleTime = 0;
+    _idleStart = _windowStart = trace_stamp();
+}
+
+/** Accounts the time that the background thread holds the CPU.
+  * @param th: Thread that gets the CPU. */
+static void _countIdle( thread_t const* th ) {
+    if ( th == _running ) return;
+    uint32_t const now = trace_stamp();
+    if ( _running == &_background ) _idleTime += now - _idleStart;
+    if ( th == &_background ) _idleStart = now;
+}
+
+#else
+
+/** The idle time is not measured in the context switches. */
+static void _initIdle( void ) { }
+static void _countIdle( thread_t const* th ) { (void)th; }
+
+#endif /* ANYRTOS_IDLE_LPM */
+
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+
+/** Measures of the sites that disable the interrupts. */
+static latencySite_t _sites[ ANYRTOS_LATENCY ];
+
+/** Site of the running measure. NULL if there is not one. */
+static void const* _irqSite;
+
+/** Value of trace_stamp() when the interrupts were disabled. */
+static uint32_t _irqStart;
+
+/** Adds a measure to the table of sites. When the table is full the last
+  * entry gathers the rest of sites.
+  * @param site: Return address of the site.
+  * @param time: Time with the interrupts disabled. */
+static void _irqRecord( void const* site, uint32_t time ) {
+    latencySite_t* s = _sites;
+    latencySite_t* const last = &_sites[ ANYRTOS_LATENCY - 1 ];
+    while( ( s < last ) && s->count && ( s->site != site ) ) ++s;
+    if ( !s->count ) s->site = site;
+    else if ( s->site != site ) s->site = (void const*)0;
+    ++s->count;
+    if ( time > s->max ) s->max = time;
+    unsigned int bucket = 0;
+    while( time && ( bucket < LATENCY_BUCKETS - 1 ) ) {
+        time >>= 1;
+        ++bucket;
+    }
+    if ( s->hist[ bucket ] < UINT16_MAX ) ++s->hist[ bucket ];
+}
+
+/** Starts a measure for the site of the running thread. It must be called
+  * just after disabling the interrupts. */
+static void _irqOff( void ) {
+    _irqSite = _running->irqSite;
+    _irqStart = trace_stamp();
+}
+
+/** Ends the running measure. It must be called just before enabling the
+  * interrupts. */
+static void _irqOn( void ) {
+    if ( _irqSite ) _irqRecord( _irqSite, trace_stamp() - _irqStart );
+    _irqSite = (void const*)0;
+}
+
+/** A thread preempted by an interrupt enables them when it gets the CPU, so
+  * the running measure is discarded. A thread blocked in a critical section
+  * keeps them disabled, so a measure is started for it if there is not one.
+  * @param th: Thread that gets the CPU. */
+static void _irqSwitch( thread_t const* th ) {
+    if ( !th->critical ) _irqSite = (void const*)0;
+    else if ( !_irqSite ) {
+        _irqSite = th->irqSite;
+        _irqStart = trace_stamp();
+    }
+}
+
+/** Stamps the wakeup of a thread.
+  * @param th: Thread handler. */
+static void _stampWakeup( thread_t* th ) { th->wakeStamp = trace_stamp(); }
+
+#else
+
+/** Without latency meter nothing is measured. */
+static void _irqOff( void ) { }
+static void _irqOn( void ) { }
+static void _irqSwitch( thread_t const* th ) { (void)th; }
+static void _stampWakeup( thread_t* th ) { (void)th; }
+
+#endif /* ANYRTOS_LATENCY */
+
+/** Puts a thread in ready state.
+  * @param th: Thread handler.
+  * @param by: Source of the wakeup for the trace. */
+static void _setReady( thread_t* th, uint8_t by ) {
+    _traceEvent( TRACE_WAKEUP, by, th );
+    _countWakeup( th );
+    _stampWakeup( th );
+    threadQueueArray_put( _ready, &_readyMap, th );
+}
+
+/** Puts all threads of a list sorted by priority in ready state.
+  * @param list: The list handler. */
+static void _setListReady( priorList_t* list ) {
+#if ( defined(ANYRTOS_TRACE) && ANYRTOS_TRACE ) || ( defined(ANYRTOS_STATS) && ANYRTOS_STATS ) \
+    || ( defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY )
+    for( thread_t* i = list->first; i; i = i->nextPr ) {
+        _traceEvent( TRACE_WAKEUP, TRACE_BY_NOTIFY, i );
+        _countWakeup( i );
+        _stampWakeup( i );
+    }
+#endif
+    threadQueueArray_putList( _ready, &_readyMap, list );
+}
+
 /* Initializes the scheduler. */
 void scheduler_init( void ) {
     portable_dint();
     _running = (thread_t *volatile)&_background; 
-    _running->prior = LOWEST_PRIOR;
+    thread_init( _running, LOWEST_PRIOR );
     _running->critical = 1;      
-    threadQueueArray_flush( _ready, REALY_PRIOR_QTY );     
+    threadQueueArray_flush( _ready, &_readyMap, REALY_PRIOR_QTY );     
+    _initStats();
+    _initIdle();
 }
 
 /* Adds a new thread to scheduler. */
 void scheduler_add( threadInfo_t const* info ) {
-    portable_initContext( info );
     thread_init( info->th, info->prior );      
-    threadQueueArray_put( _ready, info->th );    
+    _paintStack( info );
+    portable_initContext( info );
+    _addStats( info->th );
+    _setReady( info->th, TRACE_BY_START );
 }
 
-/** Change context to the highest priority ready thread. */
-static void _jump( void ) { 
-    thread_t* th = threadQueueArray_get( _ready, REALY_PRIOR_QTY );
+/** Change context to the highest priority ready thread.
+  * @param reason: Reason why the running thread leaves the CPU for the trace. */
+static void _jump( uint8_t reason ) { 
+    _checkStack( _running );
+    _traceEvent( TRACE_BLOCK, reason, _running );
+    thread_t* th = threadQueueArray_get( _ready, &_readyMap );
+    _traceEvent( TRACE_SWITCH, 0, th );
+    _countSwitch( th, reason );
+    _countIdle( th );
+    _irqSwitch( th );
+    _startSlice( th );
     portable_changeContext( &_running, th );
 }
 
 /** Sets the running thread in ready list and jump. */
 static void _yieldISR( void ) {   
-    threadQueueArray_put( _ready, _running );
-    _jump();    
+    threadQueueArray_put( _ready, &_readyMap, _running );
+    _jump( TRACE_READY );    
 }
 
 /** Enables and disables IRQ. It must be called inside of critical section. */
 static void _checkIRQ( void ) {
+    _irqOn();
     portable_eint();
     portable_dint();    
+    _irqOff();
 }
 
 /** Sets the running thread in ready list and jump. */
@@ -88,7 +431,7 @@ static void _yield( void ) {
 
 /** Puts a thread in a ready queue and yileds if necesary. */
 static void _resume( thread_t* th ) {
-    threadQueueArray_put( _ready, th );
+    _setReady( th, TRACE_BY_NOTIFY );
     if ( th->prior < _running->prior ) _yield();    
 }
 
@@ -96,7 +439,7 @@ static void _resume( thread_t* th ) {
   * @param list: The list handler. */
 static void _waitInPriorList( priorList_t* list ) {
     priorList_put( list, _running );
-    _jump();
+    _jump( TRACE_WAIT );
     _checkIRQ();
 }
 
@@ -112,7 +455,7 @@ static void _resumeFromPriorList( priorList_t* list ) {
 static void _resumeFullPriorList( priorList_t* list ) {
     if ( !priorList_isEmpty( list ) ) {
         uint8_t prior = list->first->prior;
-        threadQueueArray_putList( _ready, list );
+        _setListReady( list );
         if ( prior < _running->prior ) _yield();        
     }
 }
@@ -125,7 +468,7 @@ static void _resumeFullPriorList( priorList_t* list ) {
 static bool _resumeFromPriorListISR( priorList_t* list ) {
     thread_t* th = priorList_get( list );
     if( !th ) return false;
-    threadQueueArray_put( _ready, th );
+    _setReady( th, TRACE_BY_NOTIFY );
     return ( th->prior < _running->prior );          
 }
 
@@ -137,28 +480,196 @@ static bool _resumeFromPriorListISR( priorList_t* list ) {
 static bool _resumeFullPriorListISR( priorList_t* list ) {
     if ( priorList_isEmpty( list ) ) return false;
     uint8_t prior = list->first->prior;
-    threadQueueArray_putList( _ready, list );
+    _setListReady( list );
     return ( prior < _running->prior );       
 }
 
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+
+/** Enter in a critical section in the context of the running thread. The
+  * site is the return address of the function that enters. */
+#define _enterCritical() _enterCriticalFrom( __builtin_return_address( 0 ) )
+
+/** Enter in a critical section in the context of the running thread.
+  * @param site: Return address of the function that enters. */
+static void _enterCriticalFrom( void const* site ) {
+    portable_dint();
+    if ( !_running->critical++ ) {
+        _running->irqSite = site;
+        _irqOff();
+    }
+}
+
+#else
+
 /** Enter in a critical section in the context of the running thread.*/
 static void _enterCritical( void ) {
     portable_dint();
     ++_running->critical;
 }
 
+#endif /* ANYRTOS_LATENCY */
+
 /** Exit of a critical section in the context of the running thread. */
 static void _exitCritical( void ) {
-    if( !--_running->critical ) portable_eint();
+    if( !--_running->critical ) {
+        _irqOn();
+        portable_eint();
+    }
 }
 
 /* Starts the scheduler. */
 void scheduler_run( void ) {
     _yield();
     _running->critical = 0; 
+    _irqOn();
     portable_eint();
 }
 
+#if defined(ANYRTOS_TIME_SLICE) && ANYRTOS_TIME_SLICE
+
+/* Sets the quantum of a thread. */
+void scheduler_setSlice( thread_t* th, tick_t ticks ) {
+    _enterCritical();
+    th->slice = ticks;
+    th->sliceLeft = ticks;
+    _exitCritical();
+}
+
+/* Sets the timer whose ticks count in the quanta. */
+void scheduler_setSliceTimer( timer_t const* timer ) {
+    _enterCritical();
+    _sliceTimer = timer;
+    _exitCritical();
+}
+
+#endif /* ANYRTOS_TIME_SLICE */
+
+#if defined(ANYRTOS_STATS) && ANYRTOS_STATS
+
+/* Copies the accounting of the threads added to the scheduler. */
+size_t scheduler_stats( threadStats_t dst[], size_t qty ) {
+    _enterCritical();
+    _countSwitch( _running, TRACE_READY );
+    size_t i = 0;
+    for( thread_t const* th = &_background; th && i < qty; th = th->nextSt, ++i ) {
+        dst[i].th = th;
+        dst[i].prior = th->prior;
+        dst[i].runTime = th->runTime;
+        dst[i].voluntary = th->voluntary;
+        dst[i].involuntary = th->involuntary;
+        dst[i].wakeups = th->wakeups;
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+        dst[i].stackUnused = scheduler_stackUnused( th );
+#endif
+    }
+    _exitCritical();
+    return i;
+}
+
+#endif /* ANYRTOS_STATS */
+
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+
+/* Gets the bytes of the stack of a thread that have never been used. */
+size_t scheduler_stackUnused( thread_t const* th ) {
+    size_t i = 0;
+    if ( th->stack )
+        while( ( i < th->stackQty ) && ( th->stack[i] == STACK_PAINT ) ) ++i;
+    return i * sizeof(stack_t);
+}
+
+/* Traps a thread that has overwritten the lowest word of its stack. */
+__attribute__(( weak )) void scheduler_stackOverflow( thread_t* th ) {
+    (void)th;
+    portable_dint();
+    for(;;);
+}
+
+#endif /* ANYRTOS_STACK_CHECK */
+
+
+
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+
+/** Changes the priority of a thread. A ready thread is moved to the queue of
+  * its new priority and a thread waiting a mutex is sorted again in the list 
+  * of the mutex. In other lists the thread keeps its place, except with
+  * ANYRTOS_PRIOR_BUCKETS where it is sorted again too.
+  * @param th: Thread handler.
+  * @param prior: The new priority. */
+static void _changePriority( thread_t* th, prior_t prior ) {
+    if ( ( th != _running ) && threadQueueArray_remove( _ready, &_readyMap, th ) ) {
+        th->prior = prior;
+        threadQueueArray_put( _ready, &_readyMap, th );
+    }
+    else if ( th->waiting && thread_isInPriorList( th ) ) {
+        thread_removeFromPriorList( th );
+        th->prior = prior;
+        priorList_put( &th->waiting->list, th );
+    }
+#if defined(ANYRTOS_PRIOR_BUCKETS) && ANYRTOS_PRIOR_BUCKETS
+    else if ( thread_isInPriorList( th ) ) {
+        /* A thread is kept in the bucket of its priority in every list: */
+        priorList_t* list = th->waitList;
+        thread_removeFromPriorList( th );
+        th->prior = prior;
+        priorList_put( list, th );
+    }
+#endif
+    else th->prior = prior;
+}
+
+/** Calculates the priority of a thread from its base priority and from the
+  * threads that are waiting the mutexes that it owns. If the priority 
+  * changes, the owner of the mutex that the thread is waiting is updated too.
+  * @param th: Thread handler. Null pointer is allowed. */
+static void _updatePriority( thread_t* th ) {
+    while( th ) {
+        prior_t prior = th->base;
+        for( mutex_t const* i = th->owned; i; i = i->next )
+            if ( !priorList_isEmpty( &i->list ) && ( i->list.first->prior < prior ) )
+                prior = i->list.first->prior;
+        if ( prior == th->prior ) return;
+        _changePriority( th, prior );
+        th = th->waiting? th->waiting->busy: (thread_t*)0;
+    }
+}
+
+#endif /* ANYRTOS_USE_INHERITANCE */
+
+#if ( defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE ) \
+ || ( defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS )
+
+/** Yields if there is a ready thread with higher priority than the running
+  * thread. It is used after the running thread loses inherited priority and
+  * after a timer in tickless mode is updated. */
+static void _yieldIfPreempted( void ) {
+    if ( priorMap_isEmpty( &_readyMap ) ) return;
+    if ( priorMap_first( &_readyMap ) < _running->prior ) _yield();
+}
+
+#endif
+
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+
+/** Updates the tick counter of a timer driven in tickless mode. The threads
+  * whose timeouts have expired are resumed and a thread with higher priority
+  * preempts the running thread. Equal priorities keep waiting.
+  * @param timer: Timer handler. */
+static void _syncTimer( timer_t const* timer ) {
+    timer_sync( timer );
+    _yieldIfPreempted();
+}
+
+#else
+
+/** The tick counter of a periodic timer is always updated.
+  * @param timer: Timer handler. */
+static void _syncTimer( timer_t const* timer ) { (void)timer; }
+
+#endif /* ANYRTOS_TICKLESS */
+
 
 
 /* ------------------------------------------------------------------------ */
@@ -175,6 +686,7 @@ void task_exitCritical( void ) { _exitCritical(); }
 /* Updates the timestamp of the running thread with a timer. */
 void task_updateTick( timer_t const* timer ) {
     _enterCritical();
+    _syncTimer( timer );
     _running->tick = timer->tick;
     _exitCritical();    
 }
@@ -189,6 +701,7 @@ void task_increaseTimeout( tick_t ticks ) {
 /* Updates the timestamp of the running thread with a timer. */
 void task_setTimeout( timer_t const* timer, tick_t ticks ) {
     _enterCritical();
+    _syncTimer( timer );
     _running->tick = timer->tick + ticks;
     _exitCritical();    
 }
@@ -196,6 +709,7 @@ void task_setTimeout( timer_t const* timer, tick_t ticks ) {
 /* Checks if the counter tick of a timer has been got the task tick. */
 bool task_isOver( timer_t const* timer ) {
     _enterCritical();
+    _syncTimer( timer );
     bool retVal = tick_isOver( timer->tick, _running->tick );
     _exitCritical();  
     return retVal;
@@ -212,8 +726,14 @@ prior_t task_getPriority( void ) {
 /* Set a new priority to task. */
 prior_t task_setPriority( prior_t prior ) { 
     _enterCritical();
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+    prior_t retVal = _running->base;
+    _running->base = prior;
+    _updatePriority( _running );
+#else
     prior_t retVal = _running->prior;
     _running->prior = prior;
+#endif
     _exitCritical();  
     return retVal;
 }
@@ -221,7 +741,9 @@ prior_t task_setPriority( prior_t prior ) {
 /* Yields the flow of execution to threads of greater than or equal priority. */
 void task_yield( void ) {
     _enterCritical();    
-    _yield();
+    threadQueueArray_put( _ready, &_readyMap, _running );
+    _jump( TRACE_YIELD );
+    _checkIRQ();
     _exitCritical();
 }
 
@@ -231,7 +753,7 @@ void task_yieldISR( void ) { _yieldISR(); }
 /* Sets the running thread in suspended state. */
 void task_suspend( void ) {
     _enterCritical();
-    _jump(); 
+    _jump( TRACE_SUSPEND ); 
     _exitCritical();    
 }
 
@@ -294,24 +816,104 @@ bool event_notifyAllISR( event_t *event ) {
 /* ------------------------------------------ Mutual Exclusion Control: --- */
 /* ------------------------------------------------------------------------ */
 
-/** Tries to enter in mutual exclusion section.
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+
+/** Sets a thread as owner of a mutex. It inherits the priority of the 
+  * threads that are still waiting the mutex.
+  * @param mutex: Mutual exclusion handler.
+  * @param th: The new owner. */
+static void _ownMutex( mutex_t* mutex, thread_t* th ) {
+    mutex->busy = th;
+    mutex->next = th->owned;
+    th->owned = mutex;
+    th->waiting = (mutex_t*)0;
+    _updatePriority( th );
+}
+
+/** Frees a mutex. Its owner loses the priority inherited by the mutex.
+  * @param mutex: Mutual exclusion handler. */
+static void _disownMutex( mutex_t* mutex ) {
+    thread_t* owner = mutex->busy;
+    if ( !owner ) return;
+    mutex_t** i;
+    for( i = &owner->owned; *i && ( *i != mutex ); i = &(*i)->next );
+    if ( *i ) *i = mutex->next;
+    mutex->busy = (thread_t*)0;
+    _updatePriority( owner );
+}
+
+/** Sets the running thread blocked until it gets the ownership of a mutex. 
+  * The owner of the mutex inherits the priority of the running thread if it
+  * is higher.
+  * @param mutex: Mutual exclusion handler. */
+static void _waitMutex( mutex_t* mutex ) {
+    _running->waiting = mutex;
+    priorList_put( &mutex->list, _running );
+    _updatePriority( mutex->busy );
+    _jump( TRACE_WAIT );
+    _checkIRQ();
+}
+
+/** Resumes a thread that has got the ownership of a mutex. It yields if the
+  * running thread does not have the highest priority any more.
+  * @param th: Thread handler. */
+static void _resumeOwner( thread_t* th ) {
+    _setReady( th, TRACE_BY_NOTIFY );
+    _yieldIfPreempted();
+}
+
+#else
+
+/** Sets a thread as owner of a mutex.
+  * @param mutex: Mutual exclusion handler.
+  * @param th: The new owner. */
+static void _ownMutex( mutex_t* mutex, thread_t* th ) { mutex->busy = th; }
+
+/** Frees a mutex.
+  * @param mutex: Mutual exclusion handler. */
+static void _disownMutex( mutex_t* mutex ) { mutex->busy = (thread_t*)0; }
+
+/** Sets the running thread blocked until it gets the ownership of a mutex.
+  * @param mutex: Mutual exclusion handler. */
+static void _waitMutex( mutex_t* mutex ) { _waitInPriorList( &mutex->list ); }
+
+/** Resumes a thread that has got the ownership of a mutex.
+  * @param th: Thread handler. */
+static void _resumeOwner( thread_t* th ) { _resume( th ); }
+
+#endif /* ANYRTOS_USE_INHERITANCE */
+
+/** Enters in mutual exclusion section. If it is busy, the ownership is
+  * handed to the running thread when the owner exits.
   * @param event: Mutual exclusion handler. */ 
 static inline void _enterMutex( mutex_t* mutex ) {
-    while( mutex->busy ) _waitInPriorList( &mutex->list );
-    mutex->busy = _running;
+    if ( mutex->busy ) _waitMutex( mutex );
+    else _ownMutex( mutex, _running );
 }
 
-/** Exits of mutual exclusion.
+/** Exits of mutual exclusion. The ownership is handed directly to the 
+  * highest priority waiting thread, which is the only one resumed.
   * @param event: Mutual exclusion handler. */
 static inline void _exitMutex( mutex_t* mutex ) {
-    mutex->busy = (thread_t*)0;
-    _resumeFullPriorList( &mutex->list );    /* FIXME: full? */
+    _disownMutex( mutex );
+    thread_t* th = priorList_get( &mutex->list );
+    if ( !th ) {
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+        _yieldIfPreempted();
+#endif
+        return;
+    }
+    _ownMutex( mutex, th );
+    _resumeOwner( th );
 }
 
 /* Initializes a mutual exclusion handler. */
 void mutex_init( mutex_t* mutex ) {
     priorList_flush( &mutex->list );
     mutex->busy = (thread_t*)0;
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+    mutex->next = (mutex_t*)0;
+#endif
 }
 
 /* Enters in critical section and tries to enter in mutual exclusion section. */
@@ -346,30 +948,161 @@ void mutex_exit( mutex_t* mutex ) {
 /* ----------------------------------------------------- Timer Control: --- */
 /* ------------------------------------------------------------------------ */
 
+#if defined(ANYRTOS_TIMER_WHEEL) && ANYRTOS_TIMER_WHEEL
+
+/** Empties the thread list of a timer.
+  * @param timer: Timer handler. */
+static void _flushTimer( timer_t* timer ) { tickWheel_flush( &timer->list ); }
+
+/** Puts a thread in the thread list of a timer.
+  * @param timer: Timer handler.
+  * @param th: Thread handler. */
+static void _putInTimer( timer_t* timer, thread_t* th ) {
+    tickWheel_put( &timer->list, th, timer->tick );
+}
+
+/** Removes a thread from the thread list of a timer.
+  * @param timer: Timer handler.
+  * @param th: Thread handler.
+  * @retval true: If success.
+  * @retval false: The trhead was not in the list. */
+static bool _removeFromTimer( timer_t* timer, thread_t* th ) {
+    return tickWheel_remove( &timer->list, th, timer->tick );
+}
+
+/** Sets in ready state the threads whose task tick has been got by the 
+  * tick counter of a timer. Only the slot of the current tick is checked.
+  * @param timer: Timer handler.
+  * @retval true: If yield is suggested.
+  * @retval false: If yield is not necessary. */
+static bool _expireTimer( timer_t* timer ) {
+    tick_t const tick = timer->tick;
+    thread_t** slot = tickWheel_slot( &timer->list, tick );
+    bool yield = false;
+    thread_t* th;
+    while(( th = tickWheel_get( &slot, tick ) )) {
+        _setReady( th, TRACE_BY_TIMER );
+        yield |= ( th->prior < _running->prior );        
+    }
+    return yield;
+}
+
+/** Increases the tick counter of a timer N ticks. Each slot of the wheel is
+  * checked once at most.
+  * @param timer: Timer handler.
+  * @param ticks: Ticks quantity.
+  * @retval true: If yield is suggested.
+  * @retval false: If yield is not necessary. */
+static bool _advanceTimer( timer_t* timer, tick_t ticks ) {
+    if ( ticks > ANYRTOS_TIMER_WHEEL ) {
+        timer->tick += ticks - ANYRTOS_TIMER_WHEEL;
+        ticks = ANYRTOS_TIMER_WHEEL;
+    }
+    bool yield = false;
+    while( ticks-- ) {
+        ++timer->tick;
+        yield |= _expireTimer( timer );
+    }
+    return yield;
+}
+
+/** Gets the number of ticks until the next expiry of a timer.
+  * @param timer: Timer handler.
+  * @param ticks: Destination of the number of ticks.
+  * @retval true: If success.
+  * @retval false: If no thread is waiting the timer. */
+static bool _nextInTimer( timer_t const* timer, tick_t* ticks ) {
+    return tickWheel_next( &timer->list, timer->tick, ticks );
+}
+
+#else
+
+/** Empties the thread list of a timer.
+  * @param timer: Timer handler. */
+static void _flushTimer( timer_t* timer ) { tickList_flush( &timer->list ); }
+
+/** Puts a thread in the thread list of a timer.
+  * @param timer: Timer handler.
+  * @param th: Thread handler. */
+static void _putInTimer( timer_t* timer, thread_t* th ) {
+    tickList_put( &timer->list, th );
+}
+
+/** Removes a thread from the thread list of a timer.
+  * @param timer: Timer handler.
+  * @param th: Thread handler.
+  * @retval true: If success.
+  * @retval false: The trhead was not in the list. */
+static bool _removeFromTimer( timer_t* timer, thread_t* th ) {
+    return threadList_remove( &timer->list, th );
+}
+
+/** Sets in ready state the threads whose task tick has been got by the 
+  * tick counter of a timer.
+  * @param timer: Timer handler.
+  * @retval true: If yield is suggested.
+  * @retval false: If yield is not necessary. */
+static bool _expireTimer( timer_t* timer ) {
+    bool yield = false;
+    thread_t* th;
+    while(( th = tickList_get( &timer->list, timer->tick ) )) {
+        _setReady( th, TRACE_BY_TIMER );
+        yield |= ( th->prior < _running->prior );        
+    }
+    return yield;
+}
+
+/** Increases the tick counter of a timer N ticks.
+  * @param timer: Timer handler.
+  * @param ticks: Ticks quantity.
+  * @retval true: If yield is suggested.
+  * @retval false: If yield is not necessary. */
+static bool _advanceTimer( timer_t* timer, tick_t ticks ) {
+    timer->tick += ticks;
+    return _expireTimer( timer );
+}
+
+/** Gets the number of ticks until the next expiry of a timer.
+  * @param timer: Timer handler.
+  * @param ticks: Destination of the number of ticks.
+  * @retval true: If success.
+  * @retval false: If no thread is waiting the timer. */
+static bool _nextInTimer( timer_t const* timer, tick_t* ticks ) {
+    return tickList_next( &timer->list, timer->tick, ticks );
+}
+
+#endif /* ANYRTOS_TIMER_WHEEL */
+
 /* Initializes a timer handler. */
 void timer_init( timer_t* timer ) {
     timer->tick = 0;
-    tickList_flush( &timer->list );
+    _flushTimer( timer );
 } 
 
 /* Increases a tick a timer handler. */
 bool timer_tick( timer_t* timer ) {
     ++timer->tick;
-    bool yield = false;
-    thread_t* th;
-    while(( th = tickList_get( &timer->list, timer->tick ) )) {
-        threadQueueArray_put( _ready, th );
-        yield |= ( th->prior < _running->prior );        
-    }
-    return yield;
+    bool const yield = _expireTimer( timer );
+    return _countSlice( timer ) || yield;
+}
+
+/* Increases the tick counter of a timer N ticks at once. */
+bool timer_advance( timer_t* timer, tick_t ticks ) {
+    return _advanceTimer( timer, ticks );
+}
+
+/* Gets the number of ticks until the next thread waiting a timer resumes. */
+bool timer_next( timer_t const* timer, tick_t* ticks ) {
+    return _nextInTimer( timer, ticks );
 }
 
 /** Sets the running thread in blocked state until an timer event occurs.
   * More than one thread can be blocked waiting the same timer event.
   * @param timer: Timer handler. */
 static void _waitTimer( timer_t* timer ) {
-    tickList_put( &timer->list, _running );
-    _jump();     
+    _putInTimer( timer, _running );
+    _reloadTimer( timer );
+    _jump( TRACE_TIMER );     
     _checkIRQ();
 }
 
@@ -403,6 +1136,7 @@ void timer_period( timer_t* timer, tick_t ticks ) {
 void timer_delay( timer_t* timer, tick_t ticks ) {
     _enterCritical();
     tick_t tmp = _running->tick;
+    _syncTimer( timer );
     _running->tick = ticks + timer->tick;
     _waitTimer( timer );
     _running->tick = tmp;
@@ -412,8 +1146,12 @@ void timer_delay( timer_t* timer, tick_t ticks ) {
 /* Resume a thread blocked by a timer. */
 bool timer_abort( timer_t* timer, thread_t* th ) {
     _enterCritical();
-    bool retVal = threadList_remove( &timer->list, th );
-    if ( retVal ) _resume( th );
+    bool retVal = _removeFromTimer( timer, th );
+    if ( retVal ) {
+        /* A wait with timeout ends as if the timer expired: */
+        thread_removeFromPriorList( th );
+        _resume( th );
+    }
     _exitCritical();
     return retVal;    
 }
@@ -429,6 +1167,226 @@ __attribute__(( weak )) void timer_off( timer_t const* timer ) {
     (void)timer;    
 }
 
+/* ------------------------------------------------------------------------ */
+/* ----------------------------------------------------- Trace Control: --- */
+/* ------------------------------------------------------------------------ */
+
+/* Gets a free-running counter to stamp the trace events. */
+__attribute__(( weak )) uint32_t trace_stamp( void ) {
+    return 0;
+}
+
+#if defined(ANYRTOS_TRACE) && ANYRTOS_TRACE
+
+/* Records the start of an interrupt service routine. */
+void trace_isrEnter( uint8_t id ) {
+    _traceEvent( TRACE_ISR_ENTER, id, _running );
+}
+
+/* Records the end of an interrupt service routine. */
+void trace_isrExit( uint8_t id ) {
+    _traceEvent( TRACE_ISR_EXIT, id, _running );
+}
+
+/* Copies the last events recorded, the oldest one first. */
+size_t trace_read( traceEvent_t dst[], size_t qty ) {
+    _enterCritical();
+    if ( qty > _traceQty ) qty = _traceQty;
+    unsigned int const first = _traceIndex - qty;
+    for( size_t i = 0; i < qty; ++i )
+        dst[i] = _trace[ ( first + i ) & ( ANYRTOS_TRACE - 1 ) ];
+    _exitCritical();
+    return qty;
+}
+
+#endif /* ANYRTOS_TRACE */
+
+/* ------------------------------------------------------------------------ */
+/* ------------------------------------------------------ Idle Control: --- */
+/* ------------------------------------------------------------------------ */
+
+/* Does the work of the background thread. */
+__attribute__(( weak )) void idle_hook( void ) {
+#if defined(ANYRTOS_IDLE_LPM) && ANYRTOS_IDLE_LPM
+    portable_lowPower();
+#endif
+}
+
+#if defined(ANYRTOS_IDLE_LOAD) && ANYRTOS_IDLE_LOAD
+
+/** History of CPU load in tenths of percent. */
+static uint16_t _load[ ANYRTOS_IDLE_LOAD ];
+
+/** Index of the next window in the history. */
+static unsigned int _loadIndex;
+
+/** Quantity of windows in the history. */
+static unsigned int _loadQty;
+
+#if !( defined(ANYRTOS_IDLE_LPM) && ANYRTOS_IDLE_LPM )
+
+/** Passes of idle_run() in the current window. */
+static uint32_t _idlePasses;
+
+/** Passes of idle_run() in a window without load. */
+static uint32_t _reference;
+
+/** The reference is set by the application instead of the most passes. */
+static bool _fixedReference;
+
+/** Counts a pass of the background thread. */
+static void _countPass( void ) {
+    _enterCritical();
+    ++_idlePasses;
+    _exitCritical();
+}
+
+#else
+
+/** The background thread sleeps so its passes are not counted. */
+static void _countPass( void ) { }
+
+#endif /* ANYRTOS_IDLE_LPM */
+
+/** Gets the CPU load from the idle part of a window.
+  * @param idle: Idle part.
+  * @param ref: Length of the window in the same units.
+  * @return The load in tenths of percent. */
+static uint16_t _loadFrom( uint32_t idle, uint32_t ref ) {
+    if ( idle >= ref ) return 0;
+    while( idle > (uint32_t)-1 / 1000 ) {
+        idle >>= 1;
+        ref >>= 1;
+    }
+    return (uint16_t)( 1000 - idle * 1000 / ref );
+}
+
+/* Closes a window of the CPU load in an interrupt service routine. */
+void idle_windowISR( void ) {
+#if defined(ANYRTOS_IDLE_LPM) && ANYRTOS_IDLE_LPM
+    uint32_t const now = trace_stamp();
+    if ( _running == &_background ) {
+        _idleTime += now - _idleStart;
+        _idleStart = now;
+    }
+    uint32_t const idle = _idleTime;
+    uint32_t const ref = now - _windowStart;
+    _idleTime = 0;
+    _windowStart = now;
+#else
+    uint32_t const idle = _idlePasses;
+    _idlePasses = 0;
+    if ( !_fixedReference && ( idle > _reference ) ) _reference = idle;
+    uint32_t const ref = _reference;
+#endif
+    _load[ _loadIndex ] = _loadFrom( idle, ref );
+    if ( ++_loadIndex == ANYRTOS_IDLE_LOAD ) _loadIndex = 0;
+    if ( _loadQty < ANYRTOS_IDLE_LOAD ) ++_loadQty;
+}
+
+/* Closes a window of the CPU load and starts the next one. */
+void idle_window( void ) {
+    _enterCritical();
+    idle_windowISR();
+    _exitCritical();
+}
+
+/* Gets the average CPU load of the last windows. */
+unsigned int idle_load( unsigned int windows ) {
+    _enterCritical();
+    if ( windows > _loadQty ) windows = _loadQty;
+    unsigned long sum = 0;
+    unsigned int index = _loadIndex;
+    for( unsigned int i = 0; i < windows; ++i ) {
+        index = ( index? index: ANYRTOS_IDLE_LOAD ) - 1;
+        sum += _load[ index ];
+    }
+    _exitCritical();
+    return windows? (unsigned int)( sum / windows ): 0;
+}
+
+/* Sets the passes of idle_run() in a window without load. */
+void idle_setReference( uint32_t passes ) {
+#if !( defined(ANYRTOS_IDLE_LPM) && ANYRTOS_IDLE_LPM )
+    _enterCritical();
+    _reference = passes;
+    _fixedReference = ( passes != 0 );
+    _exitCritical();
+#else
+    (void)passes;
+#endif
+}
+
+#else
+
+/** Without CPU load the passes are not counted. */
+static void _countPass( void ) { }
+
+#endif /* ANYRTOS_IDLE_LOAD */
+
+/* Runs a pass of the background thread. */
+void idle_run( void ) {
+    _countPass();
+    idle_hook();
+}
+
+/* ------------------------------------------------------------------------ */
+/* --------------------------------------------------- Latency Control: --- */
+/* ------------------------------------------------------------------------ */
+
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+
+/* Copies the measures of the sites that have disabled the interrupts. */
+size_t latency_read( latencySite_t dst[], size_t qty ) {
+    _enterCritical();
+    size_t i = 0;
+    for( ; ( i < qty ) && ( i < ANYRTOS_LATENCY ) && _sites[i].count; ++i )
+        dst[i] = _sites[i];
+    _exitCritical();
+    return i;
+}
+
+/* Clears the measures of all sites. */
+void latency_reset( void ) {
+    _enterCritical();
+    for( unsigned int i = 0; i < ANYRTOS_LATENCY; ++i ) {
+        _sites[i].site = (void const*)0;
+        _sites[i].count = 0;
+        _sites[i].max = 0;
+        for( unsigned int j = 0; j < LATENCY_BUCKETS; ++j ) _sites[i].hist[j] = 0;
+    }
+    _exitCritical();
+}
+
+/* Initializes the measures of a periodic thread. */
+void jitter_init( jitter_t* jitter ) {
+    jitter->last = 0;
+    jitter->count = 0;
+    jitter->minPeriod = (uint32_t)-1;
+    jitter->maxPeriod = 0;
+    jitter->maxLatency = 0;
+}
+
+/* Waits N ticks of a timer and measures the release of the running thread. */
+void jitter_period( jitter_t* jitter, timer_t* timer, tick_t ticks ) {
+    _enterCritical();
+    _running->tick += ticks;
+    _running->wakeStamp = trace_stamp();
+    _waitTimer( timer );
+    uint32_t const now = trace_stamp();
+    uint32_t const latency = now - _running->wakeStamp;
+    if ( latency > jitter->maxLatency ) jitter->maxLatency = latency;
+    if ( jitter->count++ ) {
+        uint32_t const period = now - jitter->last;
+        if ( period < jitter->minPeriod ) jitter->minPeriod = period;
+        if ( period > jitter->maxPeriod ) jitter->maxPeriod = period;
+    }
+    jitter->last = now;
+    _exitCritical();
+}
+
+#endif /* ANYRTOS_LATENCY */
+
 /* ------------------------------------------------------------------------ */
 /* -------------------------------------------------- Smaphore Control: --- */
 /* ------------------------------------------------------------------------ */
@@ -472,6 +1430,205 @@ bool sem_signalISR( sem_t* sem ) {
 
 #endif /* ANYRTOS_USE_SEM */
 
+/* ------------------------------------------------------------------------ */
+/* ---------------------------------------- Counting Semaphore Control: --- */
+/* ------------------------------------------------------------------------ */
+
+#if defined(ANYRTOS_USE_CSEM) && ANYRTOS_USE_CSEM
+
+/** Checks if the running thread may take units. It may not overtake a
+  * waiting thread with higher or the same priority.
+  * @param csem: Counting semaphore handler. */
+static bool _mayTakeCSem( csem_t const* csem ) {
+    return !priorList_goesFirst( &csem->list, _running );
+}
+
+/** Takes units of a counting semaphore if they are available and the running
+  * thread may take them.
+  * @param csem: Counting semaphore handler.
+  * @param units: Units quantity.
+  * @retval true: If the units were taken.
+  * @retval false: If the units are not available. */
+static bool _takeCSem( csem_t* csem, unsigned int units ) {
+    if ( !_mayTakeCSem( csem ) || ( csem->units < units ) ) return false;
+    csem->units -= units;
+    return true;
+}
+
+/** Sets the running thread blocked in the list of a counting semaphore.
+  * @param csem: Counting semaphore handler.
+  * @param units: Units quantity. */
+static void _waitCSem( csem_t* csem, unsigned int units ) {
+    _running->units = units;
+    _waitInPriorList( &csem->list );
+}
+
+/** Hands units to the waiting threads in order and sets them in ready state.
+  * It stops at the first thread whose units are not available, so the
+  * threads behind it do not overtake it.
+  * @param csem: Counting semaphore handler.
+  * @retval true: If a resumed thread has higher priority than the running one.
+  * @retval false: In other case. */
+static bool _grantCSem( csem_t* csem ) {
+    bool retVal = false;
+    while( !priorList_isEmpty( &csem->list ) && ( csem->list.first->units <= csem->units ) ) {
+        thread_t* th = priorList_get( &csem->list );
+        csem->units -= th->units;
+        _setReady( th, TRACE_BY_NOTIFY );
+        if ( th->prior < _running->prior ) retVal = true;
+    }
+    return retVal;
+}
+
+/* Initializes a counting semaphore. */
+void csem_init( csem_t* csem, unsigned int units ) {
+    priorList_flush( &csem->list );
+    csem->units = units;
+}
+
+/* Waits until a number of units are available and takes them. */
+void csem_take( csem_t* csem, unsigned int units ) {
+    _enterCritical();
+    if ( !_takeCSem( csem, units ) ) _waitCSem( csem, units );
+    _exitCritical();
+}
+
+/* Takes a number of units if they are available without waiting. */
+bool csem_tryTake( csem_t* csem, unsigned int units ) {
+    _enterCritical();
+    bool retVal = _takeCSem( csem, units );
+    _exitCritical();
+    return retVal;
+}
+
+/* Gives a number of units to a counting semaphore. */
+void csem_give( csem_t* csem, unsigned int units ) {
+    _enterCritical();
+    csem->units += units;
+    if ( _grantCSem( csem ) ) _yield();
+    _exitCritical();
+}
+
+/* Gives a number of units to a counting semaphore in an interrupt service 
+ * routine. */
+bool csem_giveISR( csem_t* csem, unsigned int units ) {
+    csem->units += units;
+    return _grantCSem( csem );
+}
+
+#endif /* ANYRTOS_USE_CSEM */
+
+/* ------------------------------------------------------------------------ */
+/* ------------------------------------------ Event Flag Group Control: --- */
+/* ------------------------------------------------------------------------ */
+
+#if defined(ANYRTOS_USE_FLAGS) && ANYRTOS_USE_FLAGS
+
+/** Gets the bits of a mask that satisfy a wait condition.
+  * @param value: Bits that are set.
+  * @param mask: Bits to wait.
+  * @param mode: Wait mode.
+  * @return The bits of the mask that are set or zero if the condition is not
+  *         satisfied. */
+static unsigned int _matchFlags( unsigned int value, unsigned int mask, uint8_t mode ) {
+    unsigned int const got = value & mask;
+    if ( ( mode & FLAGS_ALL ) && ( got != mask ) ) return 0;
+    return got;
+}
+
+/** Takes the bits that satisfy the wait condition of the running thread.
+  * @param flags: Event flag group handler.
+  * @param mask: Bits to wait.
+  * @param mode: Wait mode.
+  * @return The bits got or zero if the condition is not satisfied. */
+static unsigned int _takeFlags( flags_t* flags, unsigned int mask, uint8_t mode ) {
+    unsigned int const got = _matchFlags( flags->value, mask, mode );
+    if ( got && ( mode & FLAGS_CLEAR ) ) flags->value &= ~mask;
+    return got;
+}
+
+/** Stores in the running thread handler the condition that it waits.
+  * @param mask: Bits to wait.
+  * @param mode: Wait mode. */
+static void _prepareFlags( unsigned int mask, uint8_t mode ) {
+    _running->flags = mask;
+    _running->flagsMode = mode;
+}
+
+/** Sets bits of an event flag group and puts in ready state every waiting 
+  * thread whose condition is satisfied walking the list once. The bits to
+  * clear on exit are cleared after the walk so every thread sees the same
+  * bits. The resumed threads get in its handler the bits that woke them.
+  * @param flags: Event flag group handler.
+  * @param mask: Bits to set.
+  * @retval true: If the priority of a resumed thread is higher than the 
+  *               running thread.
+  * @retval false: In other case.*/
+static bool _setFlags( flags_t* flags, unsigned int mask ) {
+    unsigned int const value = flags->value | mask;
+    unsigned int clear = 0;
+    bool retVal = false;
+    thread_t** i = &flags->list.first;
+    while( *i ) {
+        thread_t* th = *i;
+        unsigned int const got = _matchFlags( value, th->flags, th->flagsMode );
+        if ( !got ) {
+            i = &th->nextPr;
+            continue;
+        }
+        if ( th->flagsMode & FLAGS_CLEAR ) clear |= th->flags;
+        th->flags = got;
+        priorList_unlink( &flags->list, i );
+        thread_removeFromTickList( th );
+        _setReady( th, TRACE_BY_NOTIFY );
+        if ( th->prior < _running->prior ) retVal = true;
+    }
+    flags->value = value & ~clear;
+    return retVal;
+}
+
+/* Initializes an event flag group. */
+void flags_init( flags_t* flags, unsigned int value ) {
+    priorList_flush( &flags->list );
+    flags->value = value;
+}
+
+/* Sets the running thread in blocked state until the bits of a mask are set. */
+unsigned int flags_wait( flags_t* flags, unsigned int mask, uint8_t mode ) {
+    _enterCritical();
+    unsigned int retVal = _takeFlags( flags, mask, mode );
+    if ( !retVal && mask ) {
+        _prepareFlags( mask, mode );
+        _waitInPriorList( &flags->list );
+        retVal = _running->flags;
+    }
+    _exitCritical();
+    return retVal;
+}
+
+/* Sets bits of an event flag group and resumes every thread whose condition
+ * is satisfied. */
+void flags_set( flags_t* flags, unsigned int mask ) {
+    _enterCritical();
+    if ( _setFlags( flags, mask ) ) _yield();
+    _exitCritical();
+}
+
+/* Sets bits of an event flag group and resumes every thread whose condition
+ * is satisfied in an interrupt service routine. */
+bool flags_setISR( flags_t* flags, unsigned int mask ) {
+    return _setFlags( flags, mask );
+}
+
+/* Clears bits of an event flag group. */
+void flags_clear( flags_t* flags, unsigned int mask ) {
+    _enterCritical();
+    flags->value &= ~mask;
+    _exitCritical();
+}
+
+#endif /* ANYRTOS_USE_FLAGS */
+
 
 /* ------------------------------------------------------------------------ */
 /* ------------------------------------------------------------------------ */
@@ -479,21 +1636,42 @@ bool sem_signalISR( sem_t* sem ) {
 
 #if ANYRTOS_BASIC_MODE == 0
 
-static bool _waitPriorTickLists( priorList_t* priorList, tickList_t* tickList ) {
-    priorList_put( priorList, _running );
-    tickList_put( tickList, _running );
-    _jump();  
+static bool _waitPriorListTimer( priorList_t* list, timer_t* timer ) {
+    priorList_put( list, _running );
+    _putInTimer( timer, _running );
+    _reloadTimer( timer );
+    _jump( TRACE_WAIT_TIMER );  
     return thread_isRemovedFromTickList( _running );    
 }
 
 static bool _waitEventTimer( event_t* event, timer_t* timer ) {
-    return _waitPriorTickLists( &event->list, &timer->list );
+    return _waitPriorListTimer( &event->list, timer );
 }
 
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+
 static bool _waitMutexTimer( mutex_t* mutex, timer_t* timer ) {
-    return _waitPriorTickLists( &mutex->list, &timer->list );
+    _running->waiting = mutex;
+    priorList_put( &mutex->list, _running );
+    _updatePriority( mutex->busy );
+    _putInTimer( timer, _running );
+    _reloadTimer( timer );
+    _jump( TRACE_WAIT_TIMER );  
+    if ( thread_isRemovedFromTickList( _running ) ) return true;
+    /* After a timeout the owner does not inherit the priority any more: */
+    _running->waiting = (mutex_t*)0;
+    _updatePriority( mutex->busy );
+    return false;
 }
 
+#else
+
+static bool _waitMutexTimer( mutex_t* mutex, timer_t* timer ) {
+    return _waitPriorListTimer( &mutex->list, timer );
+}
+
+#endif /* ANYRTOS_USE_INHERITANCE */
+
 /* Waits until an event occurs or until the tick counter of a timer gets the 
  * task tick. */
 bool eventTimer_wait( event_t* event, timer_t* timer ) {
@@ -507,14 +1685,10 @@ bool eventTimer_wait( event_t* event, timer_t* timer ) {
   * @param event: Mutual exclusion handle. */ 
 static inline bool _enterMutexTimer( mutex_t* mutex, timer_t* timer ) {
     if ( !mutex->busy ) {
-        mutex->busy = _running;
-        return true;
-    }
-    if ( _waitMutexTimer( mutex, timer ) && !mutex->busy ) {
-        mutex->busy = _running;
+        _ownMutex( mutex, _running );
         return true;
     }
-    return false;    
+    return _waitMutexTimer( mutex, timer );
 }
 
 /* Waits until enters in mutual exclusion section or
@@ -538,7 +1712,7 @@ bool mutexTimer_enterCritical( mutex_t* mutex, timer_t* timer ) {
 #if defined(ANYRTOS_USE_SEM) && ANYRTOS_USE_SEM
 
 static bool _waitSemTimer( sem_t* sem, timer_t* timer ) {
-    return _waitPriorTickLists( &sem->list, &timer->list );
+    return _waitPriorListTimer( &sem->list, timer );
 }
 
 bool semTimer_wait( sem_t* sem, timer_t* timer ) {
@@ -555,6 +1729,38 @@ bool semTimer_wait( sem_t* sem, timer_t* timer ) {
 
 #endif /* ANYRTOS_USE_SEM */
 
+#if defined(ANYRTOS_USE_CSEM) && ANYRTOS_USE_CSEM
+
+bool csemTimer_take( csem_t* csem, timer_t* timer, unsigned int units ) {
+    _enterCritical();
+    bool retVal = _takeCSem( csem, units );
+    if ( !retVal ) {
+        _running->units = units;
+        retVal = _waitPriorListTimer( &csem->list, timer );
+        /* The waiting threads it has kept back may get their units: */
+        if ( !retVal && _grantCSem( csem ) ) _yield();
+    }
+    _exitCritical();
+    return retVal;
+}
+
+#endif /* ANYRTOS_USE_CSEM */
+
+#if defined(ANYRTOS_USE_FLAGS) && ANYRTOS_USE_FLAGS
+
+unsigned int flagsTimer_wait( flags_t* flags, timer_t* timer, unsigned int mask, uint8_t mode ) {
+    _enterCritical();
+    unsigned int retVal = _takeFlags( flags, mask, mode );
+    if ( !retVal && mask ) {
+        _prepareFlags( mask, mode );
+        if ( _waitPriorListTimer( &flags->list, timer ) ) retVal = _running->flags;
+    }
+    _exitCritical();
+    return retVal;
+}
+
+#endif /* ANYRTOS_USE_FLAGS */
+
 #endif
 
 /* ------------------------------------------------------------------------ */
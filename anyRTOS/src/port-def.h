@@ -20,9 +20,18 @@
 #ifndef _PORTABLE_DEF_
 #define _PORTABLE_DEF_
 
-#ifdef __MSP430__
+#include "anyRTOS-conf.h"
 
-#include <setjmp.h>
+/* By default the context of a thread is saved in its own stack and the thread
+ * handler only keeps the stack pointer. With ANYRTOS_LEGACY_CONTEXT the whole
+ * context is saved in the thread handler as in former versions. */
+#if defined(ANYRTOS_LEGACY_CONTEXT) && ANYRTOS_LEGACY_CONTEXT
+#define PORTABLE_LEGACY_CONTEXT 1
+#else
+#define PORTABLE_LEGACY_CONTEXT 0
+#endif
+
+#ifdef __MSP430__
 
 /** Attribute to increase the effectiveness of the threads. */
 #define thread __attribute__(( naked ))
@@ -33,6 +42,15 @@ typedef unsigned int stack_t;
 /** Type for timer tick. */
 typedef unsigned int tick_t;
 
+/** Prevents the compiler from reordering memory accesses across it. The MCU
+  * has a single core and no write buffer, so it is enough to share memory
+  * with interrupt service routines. */
+#define portable_barrier() __asm__ __volatile__( "" ::: "memory" )
+
+#if PORTABLE_LEGACY_CONTEXT
+
+#include <setjmp.h>
+
 /** Structure with data portable in threads. */
 typedef struct port_s {
     jmp_buf context; /**< MCU context */
@@ -40,6 +58,56 @@ typedef struct port_s {
 
 #else
 
+/** Structure with data portable in threads. */
+typedef struct port_s {
+    stack_t* sp; /**< Stack pointer. The registers are saved in the stack. */
+} port_t;
+
+#endif
+
+#elif defined( __x86_64__ ) && defined( __linux__ )
+
+#include <stdint.h>
+
+/** Threads are plain functions in the host. */
+#define thread
+
+/** Type for stack memory. */
+typedef uintptr_t stack_t;
+
+/** Type for timer tick. */
+typedef unsigned int tick_t;
+
+/** Prevents the compiler from reordering memory accesses across it. The
+  * interrupts are signals delivered to the same thread, so it is enough to
+  * share memory with their handlers. */
+#define portable_barrier() __asm__ __volatile__( "" ::: "memory" )
+
+#if PORTABLE_LEGACY_CONTEXT
+
+/** Structure with data portable in threads. */
+typedef struct port_s {
+    uintptr_t rsp; /**< Stack pointer. */
+    uintptr_t rbx;
+    uintptr_t rbp;
+    uintptr_t r12; /**< Thread function in new threads. */
+    uintptr_t r13; /**< Parameter of thread function in new threads. */
+    uintptr_t r14;
+    uintptr_t r15;
+    uintptr_t rip; /**< Return address. */
+} port_t;
+
+#else
+
+/** Structure with data portable in threads. */
+typedef struct port_s {
+    stack_t* sp; /**< Stack pointer. The registers are saved in the stack. */
+} port_t;
+
+#endif
+
+#else
+
 #error "Unknown MCU" 
 
 #endif
@@ -0,0 +1,215 @@
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * port-linux.c is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * port-linux.c is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <signal.h>
+#include <time.h>
+#include <stdlib.h>
+#include "port-linux.h"
+
+#if defined( __x86_64__ ) && defined( __linux__ )
+
+/* ------------------------------------------------------------------------ */
+/* --------------------------------------------------- Context Switch: --- */
+/* ------------------------------------------------------------------------ */
+
+/* Only callee-saved registers are saved because the switch is always done by
+ * a function call, both in threads and in signal handlers.
+ * portable_switchStack() saves them in the stack of the thread.
+ * portable_swapContext() saves them in port_t with ANYRTOS_LEGACY_CONTEXT,
+ * the offsets are the ones of the fields of port_t in port-def.h. */
+__asm__ (
+    "    .text                                  \n"
+    "    .globl  portable_switchStack           \n"
+    "    .type   portable_switchStack, @function\n"
+    "portable_switchStack:                      \n"
+    "    pushq   %rbp                           \n"
+    "    pushq   %rbx                           \n"
+    "    pushq   %r12                           \n"
+    "    pushq   %r13                           \n"
+    "    pushq   %r14                           \n"
+    "    pushq   %r15                           \n"
+    "    movq    %rsp, (%rdi)                   \n"
+    "    movq    %rsi, %rsp                     \n"
+    "    popq    %r15                           \n"
+    "    popq    %r14                           \n"
+    "    popq    %r13                           \n"
+    "    popq    %r12                           \n"
+    "    popq    %rbx                           \n"
+    "    popq    %rbp                           \n"
+    "    retq                                   \n"
+    "    .size   portable_switchStack, .-portable_switchStack\n"
+    "                                           \n"
+    "    .text                                  \n"
+    "    .globl  portable_swapContext           \n"
+    "    .type   portable_swapContext, @function\n"
+    "portable_swapContext:                      \n"
+    "    movq    (%rsp), %rax                   \n"
+    "    movq    %rax, 56(%rdi)                 \n"
+    "    leaq    8(%rsp), %rax                  \n"
+    "    movq    %rax, 0(%rdi)                  \n"
+    "    movq    %rbx, 8(%rdi)                  \n"
+    "    movq    %rbp, 16(%rdi)                 \n"
+    "    movq    %r12, 24(%rdi)                 \n"
+    "    movq    %r13, 32(%rdi)                 \n"
+    "    movq    %r14, 40(%rdi)                 \n"
+    "    movq    %r15, 48(%rdi)                 \n"
+    "    movq    0(%rsi), %rsp                  \n"
+    "    movq    8(%rsi), %rbx                  \n"
+    "    movq    16(%rsi), %rbp                 \n"
+    "    movq    24(%rsi), %r12                 \n"
+    "    movq    32(%rsi), %r13                 \n"
+    "    movq    40(%rsi), %r14                 \n"
+    "    movq    48(%rsi), %r15                 \n"
+    "    jmpq    *56(%rsi)                      \n"
+    "    .size   portable_swapContext, .-portable_swapContext\n"
+    "                                           \n"
+    "    .globl  portable_threadStart           \n"
+    "    .type   portable_threadStart, @function\n"
+    "portable_threadStart:                      \n"
+    "    movq    %r12, %rdi                     \n"
+    "    movq    %r13, %rsi                     \n"
+    "    callq   portable_threadEntry           \n"
+    "    .size   portable_threadStart, .-portable_threadStart\n"
+);
+
+/** Runs a thread function. It is called by portable_threadStart().
+  * @param process: Pointer to thread function.
+  * @param param: Parameter for thread. */
+__attribute__(( noreturn, used ))
+void portable_threadEntry( void(*process)(void*), void* param ) {
+    portable_eint();
+    process( param );
+    for(;;) portable_sleep();
+}
+
+
+
+/* ------------------------------------------------------------------------ */
+/* -------------------------------------------------------- Interrupts: --- */
+/* ------------------------------------------------------------------------ */
+
+/** Signal for each interrupt source. */
+static int const _signals[ PORTABLE_IRQ_QTY ] = {
+    [ PORTABLE_IRQ_TIMER ] = SIGALRM,
+    [ PORTABLE_IRQ_IO ]    = SIGIO,
+    [ PORTABLE_IRQ_USER ]  = SIGUSR1,
+};
+
+/** Interrupt service routines. */
+static void(* volatile _isr[ PORTABLE_IRQ_QTY ])(void);
+
+/** Set of signals blocked when interrupts are disabled. */
+static sigset_t _irqMask;
+
+/** Builds the set of signals used as interrupts before main() runs. */
+__attribute__(( constructor ))
+static void _initIrqMask( void ) {
+    sigemptyset( &_irqMask );
+    for( unsigned i = 0; i < PORTABLE_IRQ_QTY; ++i )
+        sigaddset( &_irqMask, _signals[i] );
+}
+
+/* API function that enable IRQ. */
+void portable_eint( void ) { sigprocmask( SIG_UNBLOCK, &_irqMask, NULL ); }
+
+/* API function that disable IRQ. */
+void portable_dint( void ) { sigprocmask( SIG_BLOCK, &_irqMask, NULL ); }
+
+/** Signal handler that dispatches the interrupt service routines. */
+static void _handler( int sig ) {
+    for( unsigned i = 0; i < PORTABLE_IRQ_QTY; ++i )
+        if ( ( _signals[i] == sig ) && _isr[i] ) _isr[i]();
+}
+
+/* Sets the interrupt service routine of an interrupt source. */
+void portable_irqAttach( portableIrq_t irq, void(*isr)(void) ) {
+    struct sigaction sa;
+    sa.sa_handler = _handler;
+    sa.sa_mask = _irqMask;
+    sa.sa_flags = SA_RESTART;
+    _isr[irq] = isr;
+    if ( sigaction( _signals[irq], &sa, NULL ) ) abort();
+}
+
+/* Raises an interrupt. If interrupts are disabled it remains pending. */
+void portable_irqRaise( portableIrq_t irq ) { raise( _signals[irq] ); }
+
+/* Enables interrupts and waits until an interrupt is served. */
+void portable_sleep( void ) {
+    sigset_t mask;
+    sigprocmask( SIG_BLOCK, &_irqMask, &mask );
+    for( unsigned i = 0; i < PORTABLE_IRQ_QTY; ++i )
+        sigdelset( &mask, _signals[i] );
+    sigsuspend( &mask );
+    portable_eint();
+}
+
+
+
+/* ------------------------------------------------------------------------ */
+/* ------------------------------------------------------------- Timer: --- */
+/* ------------------------------------------------------------------------ */
+
+/** POSIX interval timer that raises PORTABLE_IRQ_TIMER. */
+static timer_t _timer;
+
+/** Indicates if _timer has been created. */
+static int _timerCreated;
+
+/* Starts the periodic timer of the host. */
+void portable_timerStart( unsigned long period ) {
+    if ( !_timerCreated ) {
+        struct sigevent ev = { 0 };
+        ev.sigev_notify = SIGEV_SIGNAL;
+        ev.sigev_signo = _signals[ PORTABLE_IRQ_TIMER ];
+        if ( timer_create( CLOCK_MONOTONIC, &ev, &_timer ) ) abort();
+        _timerCreated = 1;
+    }
+    struct itimerspec spec;
+    spec.it_interval.tv_sec = period / 1000000ul;
+    spec.it_interval.tv_nsec = ( period % 1000000ul ) * 1000ul;
+    spec.it_value = spec.it_interval;
+    if ( timer_settime( _timer, 0, &spec, NULL ) ) abort();
+}
+
+/* Gets the monotonic time of the host. */
+unsigned long portable_clock( void ) {
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (unsigned long)now.tv_sec * 1000000ul + now.tv_nsec / 1000ul;
+}
+
+/* Gets the monotonic time of the host with the best resolution. */
+unsigned long portable_clockNs( void ) {
+    struct timespec now;
+    clock_gettime( CLOCK_MONOTONIC, &now );
+    return (unsigned long)now.tv_sec * 1000000000ul + (unsigned long)now.tv_nsec;
+}
+
+/* Stops the periodic timer of the host. */
+void portable_timerStop( void ) {
+    if ( !_timerCreated ) return;
+    struct itimerspec spec = { { 0, 0 }, { 0, 0 } };
+    timer_settime( _timer, 0, &spec, NULL );
+}
+
+#endif /* __x86_64__ && __linux__ */
+
+/* ------------------------------------------------------------------------ */
@@ -0,0 +1,84 @@
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * port-linux.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * port-linux.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _PORTABLE_LINUX_
+#define _PORTABLE_LINUX_
+
+/* This file does not include any anyRTOS header because anyRTOS types as
+ * stack_t or timer_t are also defined by POSIX headers. Drivers for the host
+ * port use this interface to access signals and timers of the process. */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup port-linux Linux Host Port
+  * The kernel runs in a single process. Interrupts are emulated with signals:
+  * disabling interrupts blocks the signals and an interrupt service routine
+  * is a signal handler that runs with the signals blocked.
+  * @{ */
+
+/** Interrupt sources of the host. */
+typedef enum portableIrq_e {
+    PORTABLE_IRQ_TIMER, /**< Raised periodically by portable_timerStart(). */
+    PORTABLE_IRQ_IO,    /**< Raised by asynchronous input and output. */
+    PORTABLE_IRQ_USER,  /**< Raised by portable_irqRaise(). */
+    PORTABLE_IRQ_QTY
+} portableIrq_t;
+
+/** API function that enable IRQ. */
+void portable_eint( void );
+
+/** API function that disable IRQ. */
+void portable_dint( void );
+
+/** Sets the interrupt service routine of an interrupt source.
+  * @param irq: The interrupt source.
+  * @param isr: The interrupt service routine. */
+void portable_irqAttach( portableIrq_t irq, void(*isr)(void) );
+
+/** Raises an interrupt. If interrupts are disabled it remains pending.
+  * @param irq: The interrupt source. */
+void portable_irqRaise( portableIrq_t irq );
+
+/** Starts the periodic timer of the host.
+  * @param period: Period in microseconds. */
+void portable_timerStart( unsigned long period );
+
+/** Stops the periodic timer of the host. */
+void portable_timerStop( void );
+
+/** Gets the monotonic time of the host.
+  * @return The time in microseconds. */
+unsigned long portable_clock( void );
+
+/** Gets the monotonic time of the host with the best resolution.
+  * @return The time in nanoseconds. */
+unsigned long portable_clockNs( void );
+
+/** Enables interrupts and waits until an interrupt is served. 
+  * When it returns the interrupts are enabled. */
+void portable_sleep( void );
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _PORTABLE_LINUX_ */
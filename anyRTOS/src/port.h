@@ -27,6 +27,8 @@
 #include <msp430.h>
 #include <intrinsics.h>
 
+#if PORTABLE_LEGACY_CONTEXT
+
 #if __MSP430X__ & (__MSP430_CPUX_TARGET_SR20__ | __MSP430_CPUX_TARGET_ISR20__)
 typedef unsigned long int __attribute__((__a20__)) register_t;
 #else /* any SR20 */
@@ -95,12 +97,148 @@ static inline void portable_initContext( threadInfo_t const* info ) {
 
 #endif
 
+#else /* PORTABLE_LEGACY_CONTEXT */
+
+#if __MSP430X__ & (__MSP430_CPUX_TARGET_SR20__ | __MSP430_CPUX_TARGET_ISR20__)
+#error "20-bit registers are only supported with ANYRTOS_LEGACY_CONTEXT"
+#endif /* any SR20 */
+
+/** Saves the callee-saved registers r4-r11 in the stack of the running thread
+  * and loads them from the stack of other thread.
+  * @param save: Destination of the stack pointer of the running thread.
+  * @param load: Stack pointer of the thread to be run. */
+void portable_switchStack( stack_t** save, stack_t* load );
+
+/** Entry point of new threads. It enables the interrupts and 
+  * jumps to the thread function in r11 with its parameter in r10. */
+void portable_threadStart( void );
+
+__asm__ (
+    "    .text                       \n"
+    "    .global portable_switchStack\n"
+    "portable_switchStack:           \n"
+    "    push    r4                  \n"
+    "    push    r5                  \n"
+    "    push    r6                  \n"
+    "    push    r7                  \n"
+    "    push    r8                  \n"
+    "    push    r9                  \n"
+    "    push    r10                 \n"
+    "    push    r11                 \n"
+    "    mov     r1, 0(r15)          \n"
+    "    mov     r14, r1             \n"
+    "    pop     r11                 \n"
+    "    pop     r10                 \n"
+    "    pop     r9                  \n"
+    "    pop     r8                  \n"
+    "    pop     r7                  \n"
+    "    pop     r6                  \n"
+    "    pop     r5                  \n"
+    "    pop     r4                  \n"
+    "    ret                         \n"
+    "    .global portable_threadStart\n"
+    "portable_threadStart:           \n"
+    "    eint                        \n"
+    "    mov     r10, r15            \n"
+    "    br      r11                 \n"
+);
+
+/** API function that change the context. */
+static inline void portable_changeContext( thread_t* volatile* running, thread_t* th ) {
+    thread_t* current = *running;
+    if ( current == th ) return;
+    *running = th;
+    portable_switchStack( &current->portable.sp, th->portable.sp );
+}
+
+/** API function that prepares a thread to be invoked. The stack is filled as
+  * if the thread had called to portable_switchStack() from its entry point. */
+static inline void portable_initContext( threadInfo_t const* info ) {
+    stack_t* sp = &info->stack[info->size/sizeof(stack_t)] - 9;
+    sp[0] = (stack_t)info->process;       /* r11 */
+    sp[1] = (stack_t)info->param;         /* r10 */
+    sp[8] = (stack_t)portable_threadStart; /* return address */
+    info->th->portable.sp = sp;
+}
+
+#endif /* PORTABLE_LEGACY_CONTEXT */
+
 /** API function that enable IRQ. */
 static inline void portable_eint( void ) { __eint(); }
 
 /** API function that disable IRQ. */
 static inline void portable_dint( void ) { __dint(); }
 
+/** API function that enters in low power mode with the IRQ enabled. */
+static inline void portable_lowPower( void ) { __bis_SR_register( LPM0_bits | GIE ); }
+
+#elif defined( __x86_64__ ) && defined( __linux__ )
+
+#include "port-linux.h"
+
+/** Entry point of new threads. It calls to portable_threadEntry() 
+  * with the thread function in r12 and its parameter in r13. */
+void portable_threadStart( void );
+
+#if PORTABLE_LEGACY_CONTEXT
+
+/** Saves the callee-saved registers in a context and loads them from other.
+  * It is defined in assembler in port-linux.c.
+  * @param save: Context of the running thread.
+  * @param load: Context of the thread to be run. */
+void portable_swapContext( port_t* save, port_t const* load );
+
+/** API function that change the context. */
+static inline void portable_changeContext( thread_t* volatile* running, thread_t* th ) {
+    thread_t* current = *running;
+    if ( current == th ) return;
+    *running = th;
+    portable_swapContext( &current->portable, &th->portable );
+}
+
+/** API function that prepares a thread to be invoked. */
+static inline void portable_initContext( threadInfo_t const* info ) {
+    port_t* context = &info->th->portable;
+    uintptr_t top = (uintptr_t)&info->stack[info->size/sizeof(stack_t)];
+    context->rsp = top & ~(uintptr_t)15;
+    context->r12 = (uintptr_t)info->process;
+    context->r13 = (uintptr_t)info->param;
+    context->rip = (uintptr_t)portable_threadStart;
+}
+
+#else /* PORTABLE_LEGACY_CONTEXT */
+
+/** Saves the callee-saved registers in the stack of the running thread and
+  * loads them from the stack of other thread. It is defined in assembler in
+  * port-linux.c.
+  * @param save: Destination of the stack pointer of the running thread.
+  * @param load: Stack pointer of the thread to be run. */
+void portable_switchStack( stack_t** save, stack_t* load );
+
+/** API function that change the context. */
+static inline void portable_changeContext( thread_t* volatile* running, thread_t* th ) {
+    thread_t* current = *running;
+    if ( current == th ) return;
+    *running = th;
+    portable_switchStack( &current->portable.sp, th->portable.sp );
+}
+
+/** API function that prepares a thread to be invoked. The stack is filled as
+  * if the thread had called to portable_switchStack() from its entry point. */
+static inline void portable_initContext( threadInfo_t const* info ) {
+    uintptr_t top = (uintptr_t)&info->stack[info->size/sizeof(stack_t)];
+    stack_t* sp = (stack_t*)( top & ~(uintptr_t)15 ) - 7;
+    sp[2] = (stack_t)info->param;          /* r13 */
+    sp[3] = (stack_t)info->process;        /* r12 */
+    sp[6] = (stack_t)portable_threadStart; /* return address */
+    info->th->portable.sp = sp;
+}
+
+#endif /* PORTABLE_LEGACY_CONTEXT */
+
+/** API function that waits for an IRQ with the IRQ enabled. */
+static inline void portable_lowPower( void ) { portable_sleep(); }
+
 #else
 
 #error "Unknown MCU" 
@@ -46,10 +46,45 @@ typedef struct thread_s {
     struct thread_s* nextTk;
     struct thread_s** prevPr;
     struct thread_s** prevTk;
+    void const* tickOwner;     /**< List or wheel sorted by tick where it is. */
     tick_t tick;
     port_t portable;
     crtcl_t critical;
     prior_t prior;
+#if defined(ANYRTOS_PRIOR_BUCKETS) && ANYRTOS_PRIOR_BUCKETS
+    struct priorList_s* waitList; /**< List sorted by priority where it is. */
+#endif
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+    prior_t base;              /**< Priority without inheritance. */
+    struct mutex_s* waiting;   /**< Mutex that the thread is waiting. */
+    struct mutex_s* owned;     /**< Last mutex entered by the thread. */
+#endif
+#if defined(ANYRTOS_USE_FLAGS) && ANYRTOS_USE_FLAGS
+    unsigned int flags;        /**< Flags waited and then flags got. */
+    uint_fast8_t flagsMode;    /**< Mode to wait the flags. */
+#endif
+#if defined(ANYRTOS_USE_CSEM) && ANYRTOS_USE_CSEM
+    unsigned int units;        /**< Units of a counting semaphore waited. */
+#endif
+#if defined(ANYRTOS_STATS) && ANYRTOS_STATS
+    uint32_t runTime;          /**< Time running counted with trace_stamp(). */
+    uint32_t voluntary;        /**< Times it left the CPU to wait or yield. */
+    uint32_t involuntary;      /**< Times it was preempted. */
+    uint32_t wakeups;          /**< Times it was set in ready state. */
+    struct thread_s* nextSt;   /**< Next thread added to the scheduler. */
+#endif
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+    stack_t* stack;            /**< Lowest word of the stack. */
+    size_t stackQty;           /**< Length of the stack in words. */
+#endif
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+    uint32_t wakeStamp;        /**< Value of trace_stamp() when it got ready. */
+    void const* irqSite;       /**< Site of its outermost critical section. */
+#endif
+#if defined(ANYRTOS_TIME_SLICE) && ANYRTOS_TIME_SLICE
+    tick_t slice;              /**< Quantum in ticks. 0 without slicing. */
+    tick_t sliceLeft;          /**< Ticks left of the current quantum. */
+#endif
 } thread_t;
 
 /** Initializes a thread handler.
@@ -63,6 +98,34 @@ static inline void thread_init( thread_t* th, prior_t prior ) {
     th->nextTk = (thread_t*)0;
     th->prevPr = (thread_t**)0;
     th->prevTk = (thread_t**)0;
+    th->tickOwner = (void const*)0;
+#if defined(ANYRTOS_PRIOR_BUCKETS) && ANYRTOS_PRIOR_BUCKETS
+    th->waitList = (struct priorList_s*)0;
+#endif
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+    th->base = prior;
+    th->waiting = (struct mutex_s*)0;
+    th->owned = (struct mutex_s*)0;
+#endif
+#if defined(ANYRTOS_STATS) && ANYRTOS_STATS
+    th->runTime = 0;
+    th->voluntary = 0;
+    th->involuntary = 0;
+    th->wakeups = 0;
+    th->nextSt = (thread_t*)0;
+#endif
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+    th->stack = (stack_t*)0;
+    th->stackQty = 0;
+#endif
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+    th->wakeStamp = 0;
+    th->irqSite = (void const*)0;
+#endif
+#if defined(ANYRTOS_TIME_SLICE) && ANYRTOS_TIME_SLICE
+    th->slice = ANYRTOS_TIME_SLICE;
+    th->sliceLeft = ANYRTOS_TIME_SLICE;
+#endif
 }
 
 /** Checks if a timer tick is later than another timer tick of two threads.
@@ -72,18 +135,25 @@ static inline bool thread_isOver( thread_t const* a, thread_t const* b ) {
     return tick_isOver( a->tick, b->tick );
 }
 
-/** A thread is pointed inside a list sorted by tick. 
+/** Links a thread inside a list of tick in the position of a pointer.
   * @param th: Thread handle.
-  * @param ptr: Previous pointer. */
-static inline void thread_pointedByTickList( thread_t* th, thread_t** ptr ) {
+  * @param ptr: Pointer to the thread that will be the next one. */
+static inline void thread_linkTick( thread_t* th, thread_t** ptr ) {
+    th->nextTk = *ptr;
+    if ( th->nextTk ) th->nextTk->prevTk = &th->nextTk;
     *ptr = th;
     th->prevTk = ptr;
 }
 
-/** A thread is not pointed inside a list sorted by tick. 
-  * @param th: Thread handle. */
-static inline void thread_unPointedByTickList( thread_t* th ) {
+/** Unlinks the thread pointed by a pointer inside a list of tick.
+  * @param ptr: Pointer to the thread.
+  * @return The thread handle. */
+static inline thread_t* thread_unlinkTick( thread_t** ptr ) {
+    thread_t* th = *ptr;
+    *ptr = th->nextTk;
+    if ( *ptr ) (*ptr)->prevTk = ptr;
     th->prevTk = (thread_t**)0;
+    return th;
 }
 
 /** Removes a thread form a list sorted by tick. 
@@ -91,10 +161,22 @@ static inline void thread_unPointedByTickList( thread_t* th ) {
 static inline void thread_removeFromTickList( thread_t* th ) {
     if ( th->prevTk <= (thread_t**)1 ) return;
     *th->prevTk = th->nextTk;
+    if ( th->nextTk ) th->nextTk->prevTk = th->prevTk;
     th->prevTk = (thread_t**)1;
     return;
 }
 
+/** Unlinks a thread from a list sorted by tick. It does not walk the list.
+  * @param th: Thread handle.
+  * @param owner: The list or wheel where the thread has to be.
+  * @retval true: If success.
+  * @retval false: The thread was not in that list sorted by tick. */
+static inline bool thread_unlinkFromTickList( thread_t* th, void const* owner ) {
+    if ( th->prevTk <= (thread_t**)1 || th->tickOwner != owner ) return false;
+    thread_unlinkTick( th->prevTk );
+    return true;
+}
+
 
 /** Checks if a thread has been removed form a tick list.
   * @param th: Thread handle. */ 
@@ -102,41 +184,96 @@ static inline bool thread_isRemovedFromTickList( thread_t* th ) {
     return th->prevTk == (thread_t**)1;
 }
 
-/** A thread is pointed inside a list sorted by priority. 
+/** Links a thread inside a list of priority in the position of a pointer.
   * @param th: Thread handle.
-  * @param ptr: Previous pointer. */
-static inline void thread_pointedByPriorList( thread_t* th, thread_t** ptr ) {
+  * @param ptr: Pointer to the thread that will be the next one. */
+static inline void thread_linkPrior( thread_t* th, thread_t** ptr ) {
+    th->nextPr = *ptr;
+    if ( th->nextPr ) th->nextPr->prevPr = &th->nextPr;
     *ptr = th;
     th->prevPr = ptr;
 }
 
-/** A thread is not pointed inside a list sorted by priority. 
-  * @param th: Thread handle. */
-static inline void thread_unPointedByPriorList( thread_t* th ) {
+/** Unlinks the thread pointed by a pointer inside a list of priority.
+  * @param ptr: Pointer to the thread.
+  * @return The thread handle. */
+static inline thread_t* thread_unlinkPrior( thread_t** ptr ) {
+    thread_t* th = *ptr;
+    *ptr = th->nextPr;
+    if ( *ptr ) (*ptr)->prevPr = ptr;
     th->prevPr = (thread_t**)0;
+    return th;
+}
+
+/** Checks if a thread is inside a list sorted by priority.
+  * @param th: Thread handle. */ 
+static inline bool thread_isInPriorList( thread_t const* th ) {
+    return th->prevPr;
 }
 
+#if !( defined(ANYRTOS_PRIOR_BUCKETS) && ANYRTOS_PRIOR_BUCKETS )
+
 /** Removes a thread form a list sorted by priority. 
   * @param th: Thread handle. */ 
 static inline void thread_removeFromPriorList( thread_t* th ) {
-    if ( !th->prevPr ) return;
-    *th->prevPr = th->nextPr;
-    th->prevPr = (thread_t**)0;
-    return;
+    if ( th->prevPr ) thread_unlinkPrior( th->prevPr );
 }
 
+#endif
+
+/** The threads know their place in the lists sorted by tick. */
+#define THREAD_TICK_BACKLINK 1
+
 #else
 
+#if defined(ANYRTOS_USE_INHERITANCE) && ANYRTOS_USE_INHERITANCE
+#error "The priority inheritance is not available in basic mode."
+#endif
+
+#if defined(ANYRTOS_PRIOR_BUCKETS) && ANYRTOS_PRIOR_BUCKETS
+#error "The priority buckets are not available in basic mode."
+#endif
+
 /** Structure that the scheduler uses to can handle threads. */
 typedef struct thread_s {
     union {
         struct thread_s* nextPr;
         struct thread_s* nextTk;
     };
+#if defined(ANYRTOS_BASIC_BACKLINK) && ANYRTOS_BASIC_BACKLINK
+    struct thread_s** prevTk;  /**< Its place in a list sorted by tick. */
+    void const* tickOwner;     /**< List or wheel sorted by tick where it is. */
+#endif
     tick_t tick;
     port_t portable;
     uint8_t critical;
     uint8_t prior;
+#if defined(ANYRTOS_USE_FLAGS) && ANYRTOS_USE_FLAGS
+    unsigned int flags;        /**< Flags waited and then flags got. */
+    uint8_t flagsMode;         /**< Mode to wait the flags. */
+#endif
+#if defined(ANYRTOS_USE_CSEM) && ANYRTOS_USE_CSEM
+    unsigned int units;        /**< Units of a counting semaphore waited. */
+#endif
+#if defined(ANYRTOS_STATS) && ANYRTOS_STATS
+    uint32_t runTime;          /**< Time running counted with trace_stamp(). */
+    uint32_t voluntary;        /**< Times it left the CPU to wait or yield. */
+    uint32_t involuntary;      /**< Times it was preempted. */
+    uint32_t wakeups;          /**< Times it was set in ready state. */
+    struct thread_s* nextSt;   /**< Next thread added to the scheduler. */
+#endif
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+    stack_t* stack;            /**< Lowest word of the stack. */
+    size_t stackQty;           /**< Length of the stack in words. */
+#endif
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+    uint32_t wakeStamp;        /**< Value of trace_stamp() when it got ready. */
+    void const* irqSite;       /**< Site of its outermost critical section. */
+#endif
+#if defined(ANYRTOS_TIME_SLICE) && ANYRTOS_TIME_SLICE
+    tick_t slice;              /**< Quantum in ticks. 0 without slicing. */
+    tick_t sliceLeft;          /**< Ticks left of the current quantum. */
+#endif
 } thread_t;
 
 /** Initializes a thread handler.
@@ -147,6 +284,29 @@ static inline void thread_init( thread_t* th, prior_t prior ) {
     th->tick = (tick_t)0;
     th->critical = 0;
     th->nextPr = (thread_t*)0;
+#if defined(ANYRTOS_BASIC_BACKLINK) && ANYRTOS_BASIC_BACKLINK
+    th->prevTk = (thread_t**)0;
+    th->tickOwner = (void const*)0;
+#endif
+#if defined(ANYRTOS_STATS) && ANYRTOS_STATS
+    th->runTime = 0;
+    th->voluntary = 0;
+    th->involuntary = 0;
+    th->wakeups = 0;
+    th->nextSt = (thread_t*)0;
+#endif
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+    th->stack = (stack_t*)0;
+    th->stackQty = 0;
+#endif
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+    th->wakeStamp = 0;
+    th->irqSite = (void const*)0;
+#endif
+#if defined(ANYRTOS_TIME_SLICE) && ANYRTOS_TIME_SLICE
+    th->slice = ANYRTOS_TIME_SLICE;
+    th->sliceLeft = ANYRTOS_TIME_SLICE;
+#endif
 }
 
 /** Checks if a timer tick is later than another timer tick of two threads.
@@ -156,28 +316,76 @@ static inline bool thread_isOver( thread_t const* a, thread_t const* b ) {
     return tick_isOver( a->tick, b->tick );
 }
 
-/** A thread is not pointed inside a list sorted by tick. 
-  * @param th: Thread handle. */
-static inline void thread_pointedByTickList( thread_t* th, thread_t** ptr ) {
+/** Links a thread inside a list of tick in the position of a pointer.
+  * @param th: Thread handle.
+  * @param ptr: Pointer to the thread that will be the next one. */
+static inline void thread_linkTick( thread_t* th, thread_t** ptr ) {
+    th->nextTk = *ptr;
+#if defined(ANYRTOS_BASIC_BACKLINK) && ANYRTOS_BASIC_BACKLINK
+    if ( th->nextTk ) th->nextTk->prevTk = &th->nextTk;
+    th->prevTk = ptr;
+#endif
     *ptr = th;
 }
 
-/** A thread is not pointed inside a list sorted by tick. 
-  * @param th: Thread handle. */
-static inline void thread_unPointedByTickList( thread_t* th ) { (void)th; }
+/** Unlinks the thread pointed by a pointer inside a list of tick.
+  * @param ptr: Pointer to the thread.
+  * @return The thread handle. */
+static inline thread_t* thread_unlinkTick( thread_t** ptr ) {
+    thread_t* th = *ptr;
+    *ptr = th->nextTk;
+#if defined(ANYRTOS_BASIC_BACKLINK) && ANYRTOS_BASIC_BACKLINK
+    if ( *ptr ) (*ptr)->prevTk = ptr;
+    th->prevTk = (thread_t**)0;
+#endif
+    return th;
+}
 
 /** Removes a thread form a list sorted by tick. 
   * @param th: Thread handle. */
 static inline void thread_removeFromTickList( thread_t* th ) { (void)th; }
 
-static inline void thread_pointedByPriorList( thread_t* th, thread_t** ptr ) {
-    *ptr = th;
+#if defined(ANYRTOS_BASIC_BACKLINK) && ANYRTOS_BASIC_BACKLINK
+
+/** Unlinks a thread from a list sorted by tick. It does not walk the list.
+  * In basic mode a thread is only in one list at once, so the back pointer
+  * is null when the thread is not in a list sorted by tick.
+  * @param th: Thread handle.
+  * @param owner: The list or wheel where the thread has to be.
+  * @retval true: If success.
+  * @retval false: The thread was not in that list sorted by tick. */
+static inline bool thread_unlinkFromTickList( thread_t* th, void const* owner ) {
+    if ( !th->prevTk || th->tickOwner != owner ) return false;
+    thread_unlinkTick( th->prevTk );
+    return true;
 }
 
-/** A thread is pointed inside a list sorted by priority. 
+/** The threads know their place in the lists sorted by tick. */
+#define THREAD_TICK_BACKLINK 1
+
+#else
+
+/** The lists sorted by tick have to be walked to find a thread. */
+#define THREAD_TICK_BACKLINK 0
+
+#endif
+
+/** Links a thread inside a list of priority in the position of a pointer.
   * @param th: Thread handle.
-  * @param ptr: Previous pointer. */
-static inline void thread_unPointedByPriorList( thread_t* th ) { (void)th; }
+  * @param ptr: Pointer to the thread that will be the next one. */
+static inline void thread_linkPrior( thread_t* th, thread_t** ptr ) {
+    th->nextPr = *ptr;
+    *ptr = th;
+}
+
+/** Unlinks the thread pointed by a pointer inside a list of priority.
+  * @param ptr: Pointer to the thread.
+  * @return The thread handle. */
+static inline thread_t* thread_unlinkPrior( thread_t** ptr ) {
+    thread_t* th = *ptr;
+    *ptr = th->nextPr;
+    return th;
+}
 
 /** Removes a thread form a list sorted by priority. 
   * @param th: Thread handle. */ 
@@ -186,12 +394,162 @@ static inline void thread_removeFromPriorList( thread_t* th ) { (void)th; }
 #endif
 
 
+/* ------------------------------------------------------------------------ */
+
+/** @defgroup prior-map Priority Map
+  * A bit map with a bit for each priority level. The highest priority is the
+  * most significant bit, so the highest priority set is found by counting
+  * the leading zeros in a single instruction on most cores.
+  * @{ */
+
+#if !defined(ANYRTOS_PRIORYTIES_QTY) || ( ANYRTOS_PRIORYTIES_QTY < 16 )
+
+/** Type for priority maps. */
+typedef unsigned int priorMap_t;
+
+/** Counts the leading zeros of a priority map that is not empty. */
+#define priorMap_clz( map ) __builtin_clz( map )
+
+#elif ANYRTOS_PRIORYTIES_QTY < 32
+
+typedef unsigned long priorMap_t;
+#define priorMap_clz( map ) __builtin_clzl( map )
+
+#elif ANYRTOS_PRIORYTIES_QTY < 64
+
+typedef unsigned long long priorMap_t;
+#define priorMap_clz( map ) __builtin_clzll( map )
+
+#else
+
+#error "ANYRTOS_PRIORYTIES_QTY must be less than 64."
+
+#endif
+
+/** Gets the bit of a priority level in a priority map.
+  * @param prior: The priority level. */
+static inline priorMap_t priorMap_bit( prior_t prior ) {
+    return ~( (priorMap_t)-1 >> 1 ) >> prior;
+}
+
+/** Empties a priority map.
+  * @param map: The priority map. */
+static inline void priorMap_flush( priorMap_t* map ) { *map = (priorMap_t)0; }
+
+/** Checks if a priority map is empty.
+  * @param map: The priority map. */
+static inline bool priorMap_isEmpty( priorMap_t const* map ) { return !*map; }
+
+/** Sets a priority level in a priority map.
+  * @param map: The priority map.
+  * @param prior: The priority level. */
+static inline void priorMap_set( priorMap_t* map, prior_t prior ) {
+    *map |= priorMap_bit( prior );
+}
+
+/** Clears a priority level in a priority map.
+  * @param map: The priority map.
+  * @param prior: The priority level. */
+static inline void priorMap_clear( priorMap_t* map, prior_t prior ) {
+    *map &= ~priorMap_bit( prior );
+}
+
+/** Gets the highest priority level set in a priority map.
+  * @param map: The priority map. It cannot be empty.
+  * @return The priority level. */
+static inline prior_t priorMap_first( priorMap_t const* map ) {
+    return (prior_t)priorMap_clz( *map );
+}
+
+/** Gets the lowest priority level set in a priority map.
+  * @param map: The priority map. It cannot be empty.
+  * @return The priority level. */
+static inline prior_t priorMap_last( priorMap_t const* map ) {
+    return (prior_t)priorMap_clz( *map & ( ~*map + 1 ) );
+}
+
+/** Gets the levels of a priority map from the highest one to a priority.
+  * @param map: The priority map.
+  * @param prior: The lowest priority level to get.
+  * @return A priority map with those levels. */
+static inline priorMap_t priorMap_upTo( priorMap_t const* map, prior_t prior ) {
+    return *map & ~( priorMap_bit( prior ) - 1 );
+}
+
+/** @ } */
+
+
+
 /* ------------------------------------------------------------------------ */
 
 /** @defgroup thread-prior-list  Thread Priority List.
-  * Linked list sorted by priority. 0 is the highest priority. 
+  * Linked list sorted by priority. 0 is the highest priority. The threads
+  * with the same priority are in the order they were put.
+  *
+  * With ANYRTOS_PRIOR_BUCKETS the list keeps the last thread of each
+  * priority and a priority map of the priorities in the list. A thread is
+  * put after the last one of its priority or of the nearest higher one, so
+  * putting and removing do not depend on the number of threads in the list.
   * @{ */
 
+#if defined(ANYRTOS_PRIOR_BUCKETS) && ANYRTOS_PRIOR_BUCKETS
+
+#if !defined(ANYRTOS_PRIORYTIES_QTY)
+#error "ANYRTOS_PRIORYTIES_QTY has to be defined for the priority buckets."
+#endif
+
+/** A list is defined by a pointer to first element and the last thread of
+  * each priority. If first is a null pointer the list is empty. */
+typedef struct priorList_s {
+    thread_t* first;
+    thread_t* last[ANYRTOS_PRIORYTIES_QTY]; /**< Valid if set in the map. */
+    priorMap_t map;                          /**< Priorities in the list. */
+} priorList_t;
+
+/** Empties a thread list.
+  * @param list: The list handler. */
+static inline void priorList_flush( priorList_t* list ) {
+    list->first = (thread_t *)0;
+    priorMap_flush( &list->map );
+}
+
+/** Puts a thread in a list sorted by priority.
+  * @param list: The list handler.
+  * @param th: Thread handler to be put. */
+static inline void priorList_put( priorList_t* list, thread_t* th ) {
+    priorMap_t const upTo = priorMap_upTo( &list->map, th->prior );
+    thread_t** const ptr = priorMap_isEmpty( &upTo )? &list->first:
+                           &list->last[ priorMap_last( &upTo ) ]->nextPr;
+    thread_linkPrior( th, ptr );
+    th->waitList = list;
+    list->last[th->prior] = th;
+    priorMap_set( &list->map, th->prior );
+}
+
+/** Unlinks the thread pointed by a pointer inside a list sorted by priority.
+  * @param list: The list handler.
+  * @param ptr: Pointer to the thread.
+  * @return The thread handle. */
+static inline thread_t* priorList_unlink( priorList_t* list, thread_t** ptr ) {
+    thread_t* th = *ptr;
+    if ( list->last[th->prior] == th ) {
+        /* The pointer is the field nextPr of the previous thread: */
+        thread_t* prev = ( ptr == &list->first )? (thread_t*)0:
+            (thread_t*)( (char*)ptr - offsetof( thread_t, nextPr ) );
+        if ( prev && ( prev->prior == th->prior ) ) list->last[th->prior] = prev;
+        else priorMap_clear( &list->map, th->prior );
+    }
+    return thread_unlinkPrior( ptr );
+}
+
+/** Removes a thread form a list sorted by priority. 
+  * @param th: Thread handle. */ 
+static inline void thread_removeFromPriorList( thread_t* th ) {
+    if ( th->prevPr ) priorList_unlink( th->waitList, th->prevPr );
+}
+
+#else
+
 /** A list is defined by a pointer to first element.
   * If it is a null pointer indicates that the list is empty. */
 typedef struct priorList_s {
@@ -204,6 +562,26 @@ static inline void priorList_flush( priorList_t* list ) {
     list->first = (thread_t *)0;
 }
 
+/** Puts a thread in a list sorted by priority.
+  * @param list: The list handler.
+  * @param th: Thread handler to be put. */
+static inline void priorList_put( priorList_t* list, thread_t* th ) {
+    thread_t** i;
+    for( i = &list->first; *i && !( th->prior < (*i)->prior ); i = &(*i)->nextPr );
+    thread_linkPrior( th, i );
+}
+
+/** Unlinks the thread pointed by a pointer inside a list sorted by priority.
+  * @param list: The list handler.
+  * @param ptr: Pointer to the thread.
+  * @return The thread handle. */
+static inline thread_t* priorList_unlink( priorList_t* list, thread_t** ptr ) {
+    (void)list;
+    return thread_unlinkPrior( ptr );
+}
+
+#endif /* ANYRTOS_PRIOR_BUCKETS */
+
 /** Checks if a list is empty.
   * @param list: The list handler.
   * @retval true if the list is empty.
@@ -221,20 +599,15 @@ static inline unsigned priorList_calcQty( priorList_t const* list ) {
     return qty;
 }
 
-/** Puts a thread in a list sorted by priority.
+/** Checks if the first thread of a list goes before other thread that would
+  * be put in it.
   * @param list: The list handler.
-  * @param th: Thread handler to be put. */
-static inline void priorList_put( priorList_t* list, thread_t* th ) {
-    if ( priorList_isEmpty( list ) )  {
-        list->first = th;
-        thread_pointedByPriorList( th, &list->first );
-    }
-    else {
-        thread_t* i;
-        for( i = list->first; i->nextPr && (i->nextPr->prior < th->prior); i = i->nextPr );
-        th->nextPr = i->nextPr;
-        thread_pointedByPriorList( th, &i->nextPr );
-    }
+  * @param th: Thread handler.
+  * @retval true: If the first thread of the list has higher or the same
+  *               priority.
+  * @retval false: In other case. */
+static inline bool priorList_goesFirst( priorList_t const* list, thread_t const* th ) {
+    return !priorList_isEmpty( list ) && !( th->prior < list->first->prior );
 }
 
 /** Gets the first thread of a list.
@@ -243,9 +616,7 @@ static inline void priorList_put( priorList_t* list, thread_t* th ) {
   * @retval Null pointer if the list was empty. */
 static inline thread_t* priorList_get( priorList_t *list ) {
     if ( priorList_isEmpty( list ) ) return (thread_t *)0;
-    thread_t *retVal = list->first;
-    list->first = list->first->nextPr;
-    thread_unPointedByPriorList( retVal );
+    thread_t *retVal = priorList_unlink( list, &list->first );
     thread_removeFromTickList( retVal );
     return retVal;
 }
@@ -292,17 +663,12 @@ static inline unsigned tickList_calcQty( tickList_t const* list ) {
   * @param list: The list handler.
   * @param th: Thread handler to be put. */
 static inline void tickList_put( tickList_t* list, thread_t* th ) {  
-    if ( tickList_isEmpty( list ) || thread_isOver( list->first, th ) ) {
-        th->nextTk = list->first;
-        thread_pointedByTickList( th, &list->first ); 
-        return;            
-    }    
-    for( thread_t* i = list->first;; i = i->nextTk )    
-        if ( !i->nextTk || thread_isOver( i->nextTk, th ) ) {
-            th->nextTk = i->nextTk;
-            thread_pointedByTickList( th, &i->nextTk ); 
-            return;            
-        }           
+    thread_t** i;
+    for( i = &list->first; *i && !thread_isOver( *i, th ); i = &(*i)->nextTk );
+    thread_linkTick( th, i );
+#if THREAD_TICK_BACKLINK
+    th->tickOwner = list;
+#endif
 }
 
 /** Gets the first thread of a list if its timer tick matches. 
@@ -312,36 +678,173 @@ static inline void tickList_put( tickList_t* list, thread_t* th ) {
 static inline thread_t* tickList_get( tickList_t *list, tick_t tick ) {
     if ( tickList_isEmpty( list ) ) return (thread_t *)0;
     if ( !tick_isOver( tick, list->first->tick ) ) return (thread_t *)0;
-    thread_t *retVal = list->first;
-    list->first = list->first->nextTk;
-    thread_unPointedByTickList( retVal );
+    thread_t *retVal = thread_unlinkTick( &list->first );
     thread_removeFromPriorList( retVal );
     return retVal;    
 }
 
-/** Remove a thread of a list.
+/** Remove a thread from a chain of threads linked by tick.
+  * @param ptr: Pointer to the first thread of the chain.
+  * @param th: Thread handler to be removed.
+  * @retval true: If success.
+  * @retval false: The trhead is not in the chain. */
+static inline bool threadChain_remove( thread_t** ptr, thread_t* th ) {
+    for( ; *ptr; ptr = &(*ptr)->nextTk )
+        if ( *ptr == th ) {
+            thread_unlinkTick( ptr );
+            return true;
+        }    
+    return false;
+}
+
+/** Gets the number of ticks until the earliest timer tick of a chain of 
+  * threads linked by tick. Timer ticks already got count as one tick.
+  * @param th: The first thread of the chain.
+  * @param now: The current timer tick.
+  * @param ticks: The number of ticks to be improved.
+  * @return The lesser of ticks and the ticks to the earliest timer tick. */
+static inline tick_t threadChain_ticksTo( thread_t const* th, tick_t now, tick_t ticks ) {
+    for( ; th; th = th->nextTk ) {
+        tick_t const t = tick_isOver( now, th->tick )? 1: th->tick - now;
+        if ( t < ticks ) ticks = t;
+    }
+    return ticks;
+}
+
+/** Gets the number of ticks until the timer tick of the first thread of a 
+  * list.
+  * @param list: The list handler.
+  * @param now: The current timer tick.
+  * @param ticks: Destination of the number of ticks.
+  * @retval true: If success.
+  * @retval false: If the list is empty. */
+static inline bool tickList_next( tickList_t const* list, tick_t now, tick_t* ticks ) {
+    if ( tickList_isEmpty( list ) ) return false;
+    *ticks = tick_isOver( now, list->first->tick )? 1: list->first->tick - now;
+    return true;
+}
+
+/** Remove a thread of a list. With back pointers the list is not walked but
+  * the list where the thread was put is checked.
   * @param list: The list handler.
   * @param th: Thread handler to be removed.
   * @retval true: If success.
   * @retval false: The trhead is not in list. */
 static inline bool threadList_remove( tickList_t* list, thread_t* th ) {
-    if ( tickList_isEmpty( list ) ) return false;
-    if ( list->first == th ) {
-        list->first = th->nextTk;
-        thread_unPointedByTickList( th );
-        return true;
+#if THREAD_TICK_BACKLINK
+    return thread_unlinkFromTickList( th, list );
+#else
+    return threadChain_remove( &list->first, th );
+#endif
+}
+
+/** @ } */
+
+
+/* ------------------------------------------------------------------------ */
+
+#if defined(ANYRTOS_TIMER_WHEEL) && ANYRTOS_TIMER_WHEEL
+
+/** @defgroup thread-tick-wheel  Thread Tick Wheel.
+  * Hashed array of unsorted lists of threads. A thread is put in the slot
+  * of its timer tick so putting a thread and getting the threads whose timer
+  * tick matches do not depend on the number of threads in the wheel.
+  * The size of the wheel, ANYRTOS_TIMER_WHEEL, must be a power of two.
+  * @{ */
+
+#if ANYRTOS_TIMER_WHEEL & ( ANYRTOS_TIMER_WHEEL - 1 )
+#error "ANYRTOS_TIMER_WHEEL must be a power of two."
+#endif
+
+/** A wheel is an array of pointers to the first thread of each slot. */
+typedef struct tickWheel_s {
+    thread_t* slot[ ANYRTOS_TIMER_WHEEL ];
+} tickWheel_t;
+
+/** Gets the slot of a timer tick.
+  * @param wheel: The wheel handler.
+  * @param tick: The timer tick.
+  * @return Pointer to the first thread of the slot. */
+static inline thread_t** tickWheel_slot( tickWheel_t* wheel, tick_t tick ) {
+    return &wheel->slot[ tick & (tick_t)( ANYRTOS_TIMER_WHEEL - 1 ) ];
+}
+
+/** Empties a wheel.
+  * @param wheel: The wheel handler. */
+static inline void tickWheel_flush( tickWheel_t* wheel ) {
+    for( unsigned i = 0; i < ANYRTOS_TIMER_WHEEL; ++i )
+        wheel->slot[i] = (thread_t*)0;
+}
+
+/** Puts a thread in the slot of its timer tick. If its timer tick is not 
+  * later than the current timer tick it is put in the slot of the next one.
+  * @param wheel: The wheel handler.
+  * @param th: Thread handler to be put.
+  * @param now: The current timer tick. */
+static inline void tickWheel_put( tickWheel_t* wheel, thread_t* th, tick_t now ) {
+    tick_t const tick = tick_isOver( now, th->tick )? now + 1: th->tick;
+    thread_linkTick( th, tickWheel_slot( wheel, tick ) );
+#if THREAD_TICK_BACKLINK
+    th->tickOwner = wheel;
+#endif
+}
+
+/** Gets the next thread of a slot whose timer tick matches.
+  * @param ptr: Pointer to where the searching starts. It is updated so that
+  *             the next call goes on with the searching in the same slot.
+  * @param tick: The timer tick.
+  * @retval Pointer to gotten thread if success.
+  * @retval Null if there are not more threads whose timer tick matches. */
+static inline thread_t* tickWheel_get( thread_t*** ptr, tick_t tick ) {
+    for( ; **ptr; *ptr = &(**ptr)->nextTk ) 
+        if ( tick_isOver( tick, (**ptr)->tick ) ) {
+            thread_t* th = thread_unlinkTick( *ptr );
+            thread_removeFromPriorList( th );
+            return th;
+        }
+    return (thread_t *)0;
+}
+
+/** Remove a thread of a wheel. With back pointers the slots are not walked
+  * but the wheel where the thread was put is checked.
+  * @param wheel: The wheel handler.
+  * @param th: Thread handler to be removed.
+  * @param now: The current timer tick.
+  * @retval true: If success.
+  * @retval false: The trhead is not in the wheel. */
+static inline bool tickWheel_remove( tickWheel_t* wheel, thread_t* th, tick_t now ) {
+#if THREAD_TICK_BACKLINK
+    (void)now;
+    return thread_unlinkFromTickList( th, wheel );
+#else
+    if ( threadChain_remove( tickWheel_slot( wheel, th->tick ), th ) ) return true;
+    return threadChain_remove( tickWheel_slot( wheel, now + 1 ), th );
+#endif
+}
+
+/** Gets the number of ticks until the earliest timer tick of a wheel.
+  * All slots are checked.
+  * @param wheel: The wheel handler.
+  * @param now: The current timer tick.
+  * @param ticks: Destination of the number of ticks.
+  * @retval true: If success.
+  * @retval false: If the wheel is empty. */
+static inline bool tickWheel_next( tickWheel_t const* wheel, tick_t now, tick_t* ticks ) {
+    tick_t t = (tick_t)-1;
+    bool retVal = false;
+    for( unsigned i = 0; i < ANYRTOS_TIMER_WHEEL; ++i ) {
+        if ( !wheel->slot[i] ) continue;
+        t = threadChain_ticksTo( wheel->slot[i], now, t );
+        retVal = true;
     }
-    for( thread_t* i = list->first; i->nextTk; i = i->nextTk )
-        if ( i->nextTk == th ) {
-            i->nextTk = th->nextTk;
-            thread_unPointedByTickList( th );
-            return true;
-        }    
-    return false;
+    *ticks = t;
+    return retVal;
 }
 
 /** @ } */
 
+#endif /* ANYRTOS_TIMER_WHEEL */
+
 
 /* ------------------------------------------------------------------------ */
 
@@ -400,6 +903,23 @@ static inline void threadQueue_put( threadQueue_t *queue, thread_t *th ) {
     else queue->last = queue->last->nextPr = th;
 }
 
+/** Removes a thread from a thread queue.
+  * @param queue: Thread queue handler.
+  * @param th: Thread handler.
+  * @retval true: If success.
+  * @retval false: The thread is not in the queue. */
+static inline bool threadQueue_remove( threadQueue_t *queue, thread_t *th ) {
+    thread_t* prev = (thread_t *)0;
+    for( thread_t* i = queue->first; i; prev = i, i = i->nextPr ) {
+        if ( i != th ) continue;
+        if ( prev ) prev->nextPr = th->nextPr;
+        else queue->first = th->nextPr;
+        if ( queue->last == th ) queue->last = prev;
+        return true;
+    }
+    return false;
+}
+
 /** @ } */
 
 
@@ -410,12 +930,15 @@ static inline void threadQueue_put( threadQueue_t *queue, thread_t *th ) {
   * It defines an array of queue of threads.
   * Each queue has threads with the same priority.
   * The priority of the threads in a list matches with its index in array.
+  * A priority map tracks the queues that are not empty.
   *  @{ */
 
 /** It empties all thread queues in an array.
   * @param array: Thread queue array.
+  * @param map: Priority map of the array.
   * @param size: Lists quantity of array. It cannot be 0. */
-static inline void threadQueueArray_flush( threadQueue_t array[], size_t size ) {
+static inline void threadQueueArray_flush( threadQueue_t array[], priorMap_t* map, size_t size ) {
+    priorMap_flush( map );
     for( ; ; ++array ) {
         threadQueue_flush( array );
         if ( !--size ) return;
@@ -424,28 +947,45 @@ static inline void threadQueueArray_flush( threadQueue_t array[], size_t size )
 
 /** Puts a thread in a queue array.
   * @param array: Thread queue array.
+  * @param map: Priority map of the array.
   * @param th: Thread to put.  */
-static inline void threadQueueArray_put( threadQueue_t array[], thread_t* th ) {
+static inline void threadQueueArray_put( threadQueue_t array[], priorMap_t* map, thread_t* th ) {
     threadQueue_put( &array[th->prior], th );
+    priorMap_set( map, th->prior );
 }
 
 /** Puts a list of threads in a queue array.
   * @param array: Thread queue array.
+  * @param map: Priority map of the array.
   * @param thl: Thread list to put.  */
-static inline void threadQueueArray_putList( threadQueue_t array[], priorList_t* list ) {
+static inline void threadQueueArray_putList( threadQueue_t array[], priorMap_t* map, priorList_t* list ) {
     thread_t* th;
     while(( th = priorList_get( list ) ))
-        threadQueueArray_put( array, th );
+        threadQueueArray_put( array, map, th );
+}
+
+/** Removes a thread from the queue of its priority in a queue array.
+  * @param array: Thread queue array.
+  * @param map: Priority map of the array.
+  * @param th: Thread to remove.
+  * @retval true: If success.
+  * @retval false: The thread is not in the queue array. */
+static inline bool threadQueueArray_remove( threadQueue_t array[], priorMap_t* map, thread_t* th ) {
+    if ( !threadQueue_remove( &array[th->prior], th ) ) return false;
+    if ( threadQueue_isEmpty( &array[th->prior] ) ) priorMap_clear( map, th->prior );
+    return true;
 }
 
-/** Gets a thread from an thread list vector.
+/** Gets the highest priority thread from an thread queue array.
   * @param array: Thread queue array.
+  * @param map: Priority map of the array.
   * @retval The thread if success.
-  * @retval Null pointer if the thread list vector was empty. */
-static inline thread_t* threadQueueArray_get( threadQueue_t array[], size_t size ) {
-    thread_t* th;
-    for( ; !( th = threadQueue_get( array ) ); ++array )
-        if( !--size ) return (thread_t *)0;
+  * @retval Null pointer if the thread queue array was empty. */
+static inline thread_t* threadQueueArray_get( threadQueue_t array[], priorMap_t* map ) {
+    if ( priorMap_isEmpty( map ) ) return (thread_t *)0;
+    prior_t const prior = priorMap_first( map );
+    thread_t* th = threadQueue_get( &array[prior] );
+    if ( threadQueue_isEmpty( &array[prior] ) ) priorMap_clear( map, prior );
     return th;
 }
 
@@ -30,9 +30,14 @@ extern "C" {
 /** @defgroup timer Timer Control
   * @{ */
 
-/** Structure for handle timers. */
+/** Structure for handle timers. The threads that are waiting a timer are in 
+  * a list sorted by tick or, with ANYRTOS_TIMER_WHEEL, in a hashed wheel. */
 typedef struct timer_s {
+#if defined(ANYRTOS_TIMER_WHEEL) && ANYRTOS_TIMER_WHEEL
+    tickWheel_t list;
+#else
     tickList_t list;
+#endif
     tick_t volatile tick;
 } timer_t;
 
@@ -47,6 +52,24 @@ void timer_init( timer_t* timer );
   * @retval false: If yield is not necessary. */
 bool timer_tick( timer_t* timer );
 
+/** Increases the tick counter of a timer N ticks at once and resumes all 
+  * threads whose task tick has been got. It is used by tickless timer 
+  * drivers after a wake up to account the elapsed ticks.
+  * @param timer: The timer handler.
+  * @param ticks: Elapsed ticks.
+  * @retval true: If yield is suggested.
+  * @retval false: If yield is not necessary. */
+bool timer_advance( timer_t* timer, tick_t ticks );
+
+/** Gets the number of ticks until the next thread waiting a timer resumes.
+  * It is at least one tick. It has to be invoked in critical section or from
+  * an interrupt service routine.
+  * @param timer: The timer handler.
+  * @param ticks: Destination of the number of ticks.
+  * @retval true: If success.
+  * @retval false: If no thread is waiting the timer. */
+bool timer_next( timer_t const* timer, tick_t* ticks );
+
 /** Waits until the tick counter of a timer gets the task tick.
   * @see task_setTimeout().
   * @param timer: Timer handler. */
@@ -71,11 +94,15 @@ void timer_period( timer_t* timer, tick_t ticks );
   * @param ticks: Ticks quantity to wait. */
 void timer_delay( timer_t* timer, tick_t ticks );
 
-/** Resume a thread blocked by a timer.
+/** Resume a thread blocked by a timer. A thread waiting an event, mutex, etc.
+  * with a timeout gets it as if the timer had expired. The thread has to be
+  * blocked by this timer, a thread blocked by other timer is not resumed.
+  * The time does not depend on the threads waiting the timer except in basic
+  * mode without ANYRTOS_BASIC_BACKLINK.
   * @param timer: Timer handler.
   * @param th: Thread handler.
   * @retval true: The thread was blocked.
-  * @retval false: The thread was not blocked. */
+  * @retval false: The thread was not blocked by this timer. */
 bool timer_abort( timer_t* timer, thread_t* th );
 
 /** Turn on the timer and uodate the tick.
@@ -88,6 +115,27 @@ void timer_on( timer_t const* timer );
   * @param timer: The timer handler. */
 void timer_off( timer_t const* timer );
 
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+
+/** Updates the tick counter of a timer with the ticks elapsed since the last
+  * interrupt. It is invoked in critical section before the tick counter is
+  * read to calculate a task tick. It only has to advance the timer, as with
+  * timer_advance(), and must not yield: anyRTOS yields afterwards if a
+  * thread with higher priority has been resumed.
+  * It has to be defined by user driver.
+  * @param timer: The timer handler. */
+void timer_sync( timer_t const* timer );
+
+/** Programs the next interrupt of a timer. It is invoked in critical section
+  * each time a thread starts waiting the timer, so that the driver can bring
+  * forward the interrupt if the next expiry has changed.
+  * @see timer_next().
+  * It has to be defined by user driver.
+  * @param timer: The timer handler. */
+void timer_reload( timer_t const* timer );
+
+#endif
+
 /** @} */
 
 #ifdef __cplusplus
@@ -0,0 +1,117 @@
+
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * trace.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * trace.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _TRACE_
+#define _TRACE_
+
+#include <stddef.h>
+#include <stdint.h>
+#include "anyRTOS-conf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @defgroup trace Kernel Trace
+  * With ANYRTOS_TRACE set to a power of 2 the kernel records its last events
+  * in a ring of that size. Each event is a record of 8 bytes with the same
+  * little-endian layout in every port, so a dump of trace_read() can be
+  * decoded in a host with tools/trace-decode.c.
+  * @{ */
+
+/** Kinds of trace events. */
+enum {
+    TRACE_SWITCH,    /**< The thread gets the CPU. */
+    TRACE_BLOCK,     /**< The thread leaves the CPU. The arg is the reason. */
+    TRACE_WAKEUP,    /**< The thread gets ready. The arg is the source. */
+    TRACE_ISR_ENTER, /**< An ISR starts. The arg is the ISR identifier. */
+    TRACE_ISR_EXIT   /**< An ISR ends. The arg is the ISR identifier. */
+};
+
+/** Reasons of TRACE_BLOCK. */
+enum {
+    TRACE_READY,     /**< It is preempted. It is still ready. */
+    TRACE_WAIT,      /**< It waits an event, mutex, semaphore, etc. */
+    TRACE_TIMER,     /**< It waits a timer. */
+    TRACE_WAIT_TIMER,/**< It waits an event, mutex, etc. with a timeout. */
+    TRACE_SUSPEND,   /**< It is suspended. */
+    TRACE_YIELD      /**< It calls task_yield(). It is still ready. */
+};
+
+/** Sources of TRACE_WAKEUP. */
+enum {
+    TRACE_BY_START,  /**< It is added to the scheduler. */
+    TRACE_BY_NOTIFY, /**< An event, mutex, etc., task_resume() or timer_abort(). */
+    TRACE_BY_TIMER   /**< A timer gets its task tick. */
+};
+
+/** Trace event record. */
+typedef struct traceEvent_s {
+    uint32_t stamp;  /**< Value of trace_stamp() when it was recorded. */
+    uint16_t th;     /**< Low 16 bits of the address of the thread handler. */
+    uint8_t kind;    /**< Kind of event. */
+    uint8_t arg;     /**< Reason, source or ISR identifier. */
+} traceEvent_t;
+
+/** Gets a free-running counter to stamp the trace events. The timer driver
+  * can provide it and then ANYRTOS_STAMP has to be set. By default it
+  * returns zero and only the order of the events is known. It is invoked
+  * with the interrupts disabled.
+  * @return The counter value. */
+uint32_t trace_stamp( void );
+
+#if defined(ANYRTOS_TRACE) && ANYRTOS_TRACE
+
+/** Records the start of an interrupt service routine.
+  * @param id: ISR identifier. */
+void trace_isrEnter( uint8_t id );
+
+/** Records the end of an interrupt service routine. It must be called before
+  * yielding.
+  * @param id: ISR identifier. */
+void trace_isrExit( uint8_t id );
+
+/** Copies the last events recorded, the oldest one first.
+  * @param dst: Destination array.
+  * @param qty: Length of destination array.
+  * @return The number of events copied. */
+size_t trace_read( traceEvent_t dst[], size_t qty );
+
+#else
+
+static inline void trace_isrEnter( uint8_t id ) { (void)id; }
+
+static inline void trace_isrExit( uint8_t id ) { (void)id; }
+
+static inline size_t trace_read( traceEvent_t dst[], size_t qty ) {
+    (void)dst;
+    (void)qty;
+    return 0;
+}
+
+#endif /* ANYRTOS_TRACE */
+
+/** @} */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _TRACE_ */
+
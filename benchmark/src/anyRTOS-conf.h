@@ -0,0 +1,122 @@
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * anyRTOS-conf.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * anyRTOS-conf.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _ANYRTOS_CONF_
+#define _ANYRTOS_CONF_
+
+/** Defines the number of priorities. It must be less than 64. */
+#define ANYRTOS_PRIORYTIES_QTY    3
+
+/** Saves the context of threads in thread handlers instead of in their stacks. */
+#ifndef ANYRTOS_LEGACY_CONTEXT
+#define ANYRTOS_LEGACY_CONTEXT    0
+#endif
+
+/** Number of slots of the timer wheels. It must be a power of 2.
+  * With 0 each timer keeps its threads in a single sorted list. */
+#ifndef ANYRTOS_TIMER_WHEEL
+#define ANYRTOS_TIMER_WHEEL       0
+#endif
+
+/** Drives the timers in tickless mode. The timer drivers program the next 
+  * expiry instead of every tick and have to define timer_sync() and 
+  * timer_reload(). */
+#ifndef ANYRTOS_TICKLESS
+#define ANYRTOS_TICKLESS          0
+#endif
+
+/** The owner of a mutex inherits the priority of the threads that wait it.
+  * It is not available in basic mode. */
+#ifndef ANYRTOS_USE_INHERITANCE
+#define ANYRTOS_USE_INHERITANCE   0
+#endif
+
+/** Remove some features for a better performance. */
+#define ANYRTOS_BASIC_MODE        0
+
+/** In basic mode the threads keep a back pointer in the timer lists, so
+  * timer_abort() does not walk them. It costs a pointer per thread. */
+#define ANYRTOS_BASIC_BACKLINK    0
+
+/** The lists of waiting threads keep the last thread of each priority, so a
+  * thread is put without walking them. It costs a pointer per priority in
+  * each event, mutex, etc. It is not available in basic mode. */
+#ifndef ANYRTOS_PRIOR_BUCKETS
+#define ANYRTOS_PRIOR_BUCKETS     0
+#endif
+
+/** Quantum in ticks of timer_tick() for the threads of the same priority.
+  * 0 disables the time slicing. */
+#ifndef ANYRTOS_TIME_SLICE
+#define ANYRTOS_TIME_SLICE        0
+#endif
+
+/** Application uses QUEUE */
+#define ANYRTOS_USE_QUEUE         1
+
+/** Application uses SEM */
+#define ANYRTOS_USE_SEM           1
+
+/** Application uses CSEM */
+#define ANYRTOS_USE_CSEM          1
+
+/** Application uses event flag groups */
+#define ANYRTOS_USE_FLAGS         1
+
+/** Application uses deferred work. Its pool has ANYRTOS_DEFER_QTY items. */
+#define ANYRTOS_USE_DEFER         1
+#define ANYRTOS_DEFER_QTY         4
+
+/** The timer driver defines trace_stamp() with a free-running counter. The
+  * run time of ANYRTOS_STATS, the latency meter and the CPU load with
+  * ANYRTOS_IDLE_LPM need it. */
+#define ANYRTOS_STAMP             1
+
+/** Number of events of the kernel trace ring. It must be a power of 2.
+  * With 0 the trace is disabled. */
+#ifndef ANYRTOS_TRACE
+#define ANYRTOS_TRACE             0
+#endif
+
+/** Accounts the run time, switches and wakeups of each thread. */
+#ifndef ANYRTOS_STATS
+#define ANYRTOS_STATS             0
+#endif
+
+/** Paints the stacks to measure the unused stack with 1. With 2 also checks
+  * the lowest word of the stack of the running thread in each switch. */
+#ifndef ANYRTOS_STACK_CHECK
+#define ANYRTOS_STACK_CHECK       0
+#endif
+
+/** The background thread enters in low power mode in idle_run(). */
+#define ANYRTOS_IDLE_LPM          1
+
+/** Number of windows of the CPU load history. With 0 the load is not
+  * measured. */
+#ifndef ANYRTOS_IDLE_LOAD
+#define ANYRTOS_IDLE_LOAD         0
+#endif
+
+/** Number of call sites measured by the latency meter of critical sections.
+  * With 0 the latency meter and jitter_period() are disabled. */
+#ifndef ANYRTOS_LATENCY
+#define ANYRTOS_LATENCY           0
+#endif
+
+#endif /* _ANYRTOS_CONF_ */
@@ -0,0 +1,523 @@
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * main.c is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * main.c is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Rhealstone-style benchmarks of the kernel in the host. A runner thread
+ * starts helper threads for each benchmark, times a loop of kernel calls with
+ * the monotonic clock of the host and prints the nanoseconds per operation. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include "anyRTOS.h"
+#include "queue.h"
+#include "defer.h"
+#include "src/port-linux.h"
+
+#ifndef BENCH_ITERATIONS
+#define BENCH_ITERATIONS 100000ul
+#endif
+
+/* --------------------------------------------------- Task prototypes: --- */
+static void _runner_task( void* param );
+
+/* -------------------------------------------------- Memory for tasks: --- */
+/* Signal handlers run in the stack of the interrupted thread so stacks in
+ * the host have to be much greater than in a MCU. */
+enum {
+    _STACK   = 2048,
+    _HELPERS = 32,
+};
+static stack_t _runner_stack[_STACK];
+static stack_t _defer_stack[_STACK];
+static stack_t _helper_stack[_HELPERS][_STACK];
+static thread_t _runner_th;
+static thread_t _helper_th[_HELPERS];
+
+/** Priorities of threads. The helpers that have to preempt the runner get
+  * the higher one. */
+enum {
+    _HIGH_PRIOR   = 1,
+    _RUNNER_PRIOR = 2,
+};
+
+/* ------------------------------- State and communication between task:--- */
+/** The runner asks the helpers to finish. */
+static bool volatile _stop;
+
+static event_t _event;
+static mutex_t _mutex;
+static sem_t _semA;
+static sem_t _semB;
+static csem_t _csem;
+static queue_t _queueA;
+static queue_t _queueB;
+static uint8_t _queueA_data[16];
+static uint8_t _queueB_data[16];
+static timer_t _timer;
+
+/** Time when the user interrupt was raised and latencies measured. */
+static unsigned long volatile _raised;
+static unsigned long _latencySum;
+static unsigned long _latencyMax;
+
+/* ---------------------------------------------- Functions definition: --- */
+/** Entry point of application. */
+int main( void ) {
+
+    scheduler_init();
+
+    event_init( &_event );
+    mutex_init( &_mutex );
+    sem_init( &_semA );
+    sem_init( &_semB );
+    csem_init( &_csem, 0 );
+    queue_init( &_queueA, _queueA_data, sizeof(_queueA_data) );
+    queue_init( &_queueB, _queueB_data, sizeof(_queueB_data) );
+
+    threadInfo_t const runner = {
+        .process = _runner_task,
+        .param = (void*)0,
+        .stack = _runner_stack,
+        .size = sizeof(_runner_stack),
+        .prior = _RUNNER_PRIOR,
+        .th = &_runner_th
+    };
+    scheduler_add( &runner );
+
+    defer_init( _defer_stack, sizeof(_defer_stack), _HIGH_PRIOR );
+
+    scheduler_run();
+
+    /* This is the task with the lowest priority: */
+    for(;;) idle_run();
+
+    return 0;
+}
+
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+
+/* The benchmark ticks the timer by itself. */
+void timer_sync( timer_t const* timer ) { (void)timer; }
+
+/* The benchmark has not any interrupt to be programmed. */
+void timer_reload( timer_t const* timer ) { (void)timer; }
+
+#endif
+
+/* The trace is stamped in microseconds. */
+uint32_t trace_stamp( void ) { return (uint32_t)portable_clock(); }
+
+/** Adds a helper thread to the scheduler.
+  * @param index: Index of the thread and its stack.
+  * @param process: Thread function.
+  * @param param: Parameter for thread.
+  * @param prior: Priority of thread. */
+static void _spawn( unsigned index, void(*process)(void*), void* param, prior_t prior ) {
+    threadInfo_t const info = {
+        .process = process,
+        .param = param,
+        .stack = _helper_stack[index],
+        .size = sizeof(_helper_stack[index]),
+        .prior = prior,
+        .th = &_helper_th[index]
+    };
+    task_enterCritical();
+    scheduler_add( &info );
+    task_exitCritical();
+}
+
+/** Prints the result of a benchmark.
+  * @param name: Name of the benchmark.
+  * @param elapsed: Nanoseconds elapsed.
+  * @param ops: Number of operations in the elapsed time. */
+static void _report( char const* name, unsigned long elapsed, unsigned long ops ) {
+    printf( "%-36s %10.1f ns\n", name, (double)elapsed / (double)ops );
+    fflush( stdout );
+}
+
+/* ------------------------------------------------------- Task switch: --- */
+/** Yields while the runner does. */
+thread static void _yield_task( void* param ) {
+    (void)param;
+    while( !_stop ) task_yield();
+    task_suspend();
+}
+
+/** Two threads of the same priority yield to each other. */
+static void _yield_bench( void ) {
+    _stop = false;
+    _spawn( 0, _yield_task, (void*)0, _RUNNER_PRIOR );
+    task_yield();
+    unsigned long const start = portable_clockNs();
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) task_yield();
+    unsigned long const elapsed = portable_clockNs() - start;
+    _stop = true;
+    task_yield();
+    _report( "task switch (task_yield)", elapsed, 2 * BENCH_ITERATIONS );
+}
+
+/* -------------------------------------------------------- Preemption: --- */
+/** Waits the event until the runner stops. */
+thread static void _event_task( void* param ) {
+    (void)param;
+    do event_wait( &_event ); while( !_stop );
+    task_suspend();
+}
+
+/** A notify wakes a higher priority thread that waits again. */
+static void _preempt_bench( void ) {
+    _stop = false;
+    _spawn( 0, _event_task, (void*)0, _HIGH_PRIOR );
+    task_yield();
+    unsigned long const start = portable_clockNs();
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) event_notify( &_event );
+    unsigned long const elapsed = portable_clockNs() - start;
+    _stop = true;
+    event_notify( &_event );
+    _report( "preemption (event_notify round)", elapsed, BENCH_ITERATIONS );
+}
+
+/* ---------------------------------------------------- Mutex shuffle: --- */
+/** When notified it enters in the mutex that the runner holds. */
+thread static void _mutex_task( void* param ) {
+    (void)param;
+    for(;;) {
+        event_wait( &_event );
+        if ( _stop ) break;
+        mutex_enter( &_mutex );
+        mutex_exit( &_mutex );
+    }
+    task_suspend();
+}
+
+/** A higher priority thread blocks in a mutex and gets it when the runner
+  * exits. */
+static void _mutex_bench( void ) {
+    _stop = false;
+    _spawn( 0, _mutex_task, (void*)0, _HIGH_PRIOR );
+    task_yield();
+    unsigned long const start = portable_clockNs();
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) {
+        mutex_enter( &_mutex );
+        event_notify( &_event );
+        mutex_exit( &_mutex );
+    }
+    unsigned long const elapsed = portable_clockNs() - start;
+    _stop = true;
+    event_notify( &_event );
+    _report( "mutex shuffle round", elapsed, BENCH_ITERATIONS );
+}
+
+/* ------------------------------------------------ Semaphore shuffle: --- */
+/** Answers each signal of semaphore A signalling semaphore B. */
+thread static void _sem_task( void* param ) {
+    (void)param;
+    for(;;) {
+        sem_wait( &_semA );
+        if ( _stop ) break;
+        sem_signal( &_semB );
+    }
+    task_suspend();
+}
+
+/** Two threads of the same priority play ping-pong with two semaphores. */
+static void _sem_bench( void ) {
+    _stop = false;
+    _spawn( 0, _sem_task, (void*)0, _RUNNER_PRIOR );
+    unsigned long const start = portable_clockNs();
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) {
+        sem_signal( &_semA );
+        sem_wait( &_semB );
+    }
+    unsigned long const elapsed = portable_clockNs() - start;
+    _stop = true;
+    sem_signal( &_semA );
+    task_yield();
+    _report( "semaphore ping-pong round", elapsed, BENCH_ITERATIONS );
+}
+
+/* ------------------------------------------ Counting semaphore units: --- */
+/** Waits more units than the runner gives until it stops. */
+thread static void _csemGreedy_task( void* param ) {
+    (void)param;
+    csem_take( &_csem, 5 );
+    task_suspend();
+}
+
+/** Answers each unit taken from the counting semaphore signalling B. */
+thread static void _csem_task( void* param ) {
+    (void)param;
+    for(;;) {
+        csem_take( &_csem, 1 );
+        if ( _stop ) break;
+        sem_signal( &_semB );
+    }
+    task_suspend();
+}
+
+/** The runner plays ping-pong with units of a counting semaphore with a
+  * higher priority thread while a thread that waits more units is behind. */
+static void _csem_bench( void ) {
+    _stop = false;
+    _spawn( 0, _csemGreedy_task, (void*)0, _RUNNER_PRIOR );
+    task_yield();
+    _spawn( 1, _csem_task, (void*)0, _HIGH_PRIOR );
+    task_yield();
+    unsigned long const start = portable_clockNs();
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) {
+        csem_give( &_csem, 1 );
+        sem_wait( &_semB );
+    }
+    unsigned long const elapsed = portable_clockNs() - start;
+    _stop = true;
+    csem_give( &_csem, 6 );
+    task_yield();
+    _report( "counting semaphore ping-pong round", elapsed, BENCH_ITERATIONS );
+}
+
+/** Takes a unit of the counting semaphore each time it is resumed until the
+  * runner stops. */
+thread static void _csemWaiter_task( void* param ) {
+    (void)param;
+    do csem_take( &_csem, 1 ); while( !_stop );
+    task_suspend();
+}
+
+/** Gives units one by one to a number of waiting threads. Each unit resumes
+  * only the thread that gets it.
+  * @param waiters: Number of waiting threads. */
+static void _csemGrant_bench( unsigned waiters ) {
+    _stop = false;
+    for( unsigned i = 0; i < waiters; ++i )
+        _spawn( i, _csemWaiter_task, (void*)0, _HIGH_PRIOR );
+    task_yield();
+    unsigned long const start = portable_clockNs();
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) csem_give( &_csem, 1 );
+    unsigned long const elapsed = portable_clockNs() - start;
+    _stop = true;
+    csem_give( &_csem, waiters );
+    char name[40];
+    snprintf( name, sizeof name, "csem_give with %u waiters", waiters );
+    _report( name, elapsed, BENCH_ITERATIONS );
+}
+
+/* ---------------------------------------------------- Queue shuffle: --- */
+/** Sends back by queue B each byte received by queue A. */
+thread static void _queue_task( void* param ) {
+    (void)param;
+    for(;;) {
+        uint8_t const data = queue_get8( &_queueA );
+        if ( _stop ) break;
+        queue_put8( &_queueB, data );
+    }
+    task_suspend();
+}
+
+/** Two threads of the same priority send a byte back and forth. */
+static void _queue_bench( void ) {
+    _stop = false;
+    _spawn( 0, _queue_task, (void*)0, _RUNNER_PRIOR );
+    unsigned long const start = portable_clockNs();
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) {
+        queue_put8( &_queueA, (uint8_t)i );
+        queue_get8( &_queueB );
+    }
+    unsigned long const elapsed = portable_clockNs() - start;
+    _stop = true;
+    queue_put8( &_queueA, 0 );
+    task_yield();
+    _report( "queue put8/get8 round trip", elapsed, BENCH_ITERATIONS );
+}
+
+/* ------------------------------------------------------- Timer ticks: --- */
+/** Sleeps far away in the timer until the runner aborts it. */
+thread static void _sleeper_task( void* param ) {
+    tick_t const ticks = ( (tick_t)-1 >> 2 ) + 7 * (tick_t)(uintptr_t)param;
+    task_enterCritical();
+    task_updateTick( &_timer );
+    timer_delay( &_timer, ticks );
+    task_exitCritical();
+    task_suspend();
+}
+
+/** Waits in the timer after the sleepers until the runner aborts it, and
+  * again until the runner stops.
+  * @param param: Number of sleepers. */
+thread static void _inserter_task( void* param ) {
+    tick_t const ticks = ( (tick_t)-1 >> 2 ) + 7 * (tick_t)(uintptr_t)param + 3;
+    task_enterCritical();
+    task_updateTick( &_timer );
+    while( !_stop ) timer_delay( &_timer, ticks );
+    task_exitCritical();
+    task_suspend();
+}
+
+/** Ticks a timer with a number of sleeping threads that do not expire and
+  * measures the insertion of a thread in the timer behind them.
+  * @param sleepers: Number of sleeping threads. */
+static void _tick_bench( unsigned sleepers ) {
+    timer_init( &_timer );
+    for( unsigned i = 0; i < sleepers; ++i )
+        _spawn( i, _sleeper_task, (void*)(uintptr_t)i, _HIGH_PRIOR );
+    task_yield();
+    unsigned long const ticks = BENCH_ITERATIONS < 0x10000ul? BENCH_ITERATIONS: 0x10000ul;
+    task_enterCritical();
+    unsigned long start = portable_clockNs();
+    for( unsigned long i = 0; i < ticks; ++i ) timer_tick( &_timer );
+    unsigned long elapsed = portable_clockNs() - start;
+    task_exitCritical();
+    char name[40];
+    snprintf( name, sizeof name, "timer_tick with %u sleepers", sleepers );
+    _report( name, elapsed, ticks );
+    _stop = false;
+    thread_t* const inserter = &_helper_th[sleepers];
+    _spawn( sleepers, _inserter_task, (void*)(uintptr_t)sleepers, _HIGH_PRIOR );
+    task_yield();
+    start = portable_clockNs();
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) timer_abort( &_timer, inserter );
+    elapsed = portable_clockNs() - start;
+    _stop = true;
+    timer_abort( &_timer, inserter );
+    for( unsigned i = 0; i < sleepers; ++i ) timer_abort( &_timer, &_helper_th[i] );
+    snprintf( name, sizeof name, "timer_delay+abort with %u sleepers", sleepers );
+    _report( name, elapsed, BENCH_ITERATIONS );
+}
+
+/** Waits periodically in the timer until the runner stops.
+  * @param param: Index of the thread. The period is two ticks longer. */
+thread static void _periodic_task( void* param ) {
+    tick_t const period = 2 + (tick_t)(uintptr_t)param;
+    task_updateTick( &_timer );
+    while( !_stop ) timer_period( &_timer, period );
+    task_suspend();
+}
+
+/** Ticks a timer with a number of threads of staggered periods that expire
+  * and wait again, as the timer interrupt does.
+  * @param sleepers: Number of periodic threads. */
+static void _expiry_bench( unsigned sleepers ) {
+    _stop = false;
+    timer_init( &_timer );
+    for( unsigned i = 0; i < sleepers; ++i )
+        _spawn( i, _periodic_task, (void*)(uintptr_t)i, _HIGH_PRIOR );
+    task_yield();
+    unsigned long const ticks = BENCH_ITERATIONS < 0x10000ul? BENCH_ITERATIONS: 0x10000ul;
+    task_enterCritical();
+    unsigned long const start = portable_clockNs();
+    for( unsigned long i = 0; i < ticks; ++i )
+        if ( timer_tick( &_timer ) ) task_yield();
+    unsigned long const elapsed = portable_clockNs() - start;
+    task_exitCritical();
+    _stop = true;
+    for( unsigned i = 0; i < sleepers; ++i ) timer_abort( &_timer, &_helper_th[i] );
+    char name[40];
+    snprintf( name, sizeof name, "timer_tick with %u periodic", sleepers );
+    _report( name, elapsed, ticks );
+}
+
+/* ----------------------------------------------------- ISR to thread: --- */
+/** The user interrupt notifies the event. */
+static void _user_isr( void ) {
+    if ( event_notifyISR( &_event ) ) task_yieldISR();
+}
+
+/** Measures the time from the raise of the user interrupt until it runs. */
+thread static void _latency_task( void* param ) {
+    (void)param;
+    for(;;) {
+        event_wait( &_event );
+        if ( _stop ) break;
+        unsigned long const latency = portable_clockNs() - _raised;
+        _latencySum += latency;
+        if ( latency > _latencyMax ) _latencyMax = latency;
+    }
+    task_suspend();
+}
+
+/** An interrupt service routine wakes a higher priority thread. */
+static void _isr_bench( void ) {
+    _stop = false;
+    _latencySum = 0;
+    _latencyMax = 0;
+    portable_irqAttach( PORTABLE_IRQ_USER, _user_isr );
+    _spawn( 0, _latency_task, (void*)0, _HIGH_PRIOR );
+    task_yield();
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) {
+        _raised = portable_clockNs();
+        portable_irqRaise( PORTABLE_IRQ_USER );
+    }
+    _stop = true;
+    event_notify( &_event );
+    _report( "ISR to thread latency (average)", _latencySum, BENCH_ITERATIONS );
+    _report( "ISR to thread latency (max)", _latencyMax, 1 );
+}
+
+/* ---------------------------------------------- ISR to deferred work: --- */
+/** Measures the time from the raise of the user interrupt until it runs. */
+static void _deferred_work( void* param ) {
+    (void)param;
+    unsigned long const latency = portable_clockNs() - _raised;
+    _latencySum += latency;
+    if ( latency > _latencyMax ) _latencyMax = latency;
+}
+
+/** The user interrupt posts the deferred work. */
+static void _defer_isr( void ) {
+    if ( defer_postISR( _deferred_work, (void*)0 ) == QUEUE_DOYIELD )
+        task_yieldISR();
+}
+
+/** An interrupt service routine posts work to the deferred worker. */
+static void _defer_bench( void ) {
+    _latencySum = 0;
+    _latencyMax = 0;
+    portable_irqAttach( PORTABLE_IRQ_USER, _defer_isr );
+    for( unsigned long i = 0; i < BENCH_ITERATIONS; ++i ) {
+        _raised = portable_clockNs();
+        portable_irqRaise( PORTABLE_IRQ_USER );
+    }
+    _report( "ISR to deferred work (average)", _latencySum, BENCH_ITERATIONS );
+    _report( "ISR to deferred work (max)", _latencyMax, 1 );
+}
+
+/** Runs the benchmarks and finishes. */
+thread static void _runner_task( void* param ) {
+    (void)param;
+    printf( "anyRTOS benchmarks, %lu iterations\n", (unsigned long)BENCH_ITERATIONS );
+    _yield_bench();
+    _preempt_bench();
+    _mutex_bench();
+    _sem_bench();
+    _csem_bench();
+    _csemGrant_bench( 1 );
+    _csemGrant_bench( 8 );
+    _csemGrant_bench( _HELPERS );
+    _queue_bench();
+    _tick_bench( 0 );
+    _tick_bench( 1 );
+    _tick_bench( 8 );
+    _tick_bench( _HELPERS - 1 );
+    _expiry_bench( 1 );
+    _expiry_bench( 8 );
+    _expiry_bench( _HELPERS );
+    _isr_bench();
+    _defer_bench();
+    exit( 0 );
+}
+
+/* ------------------------------------------------------------------------ */
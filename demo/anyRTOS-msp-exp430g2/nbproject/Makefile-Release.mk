@@ -35,6 +35,7 @@ OBJECTDIR=${CND_BUILDDIR}/${CND_CONF}/${CND_PLATFORM}
 
 # Object Files
 OBJECTFILES= \
+	${OBJECTDIR}/_ext/925292fd/defer.o \
 	${OBJECTDIR}/_ext/925292fd/queue.o \
 	${OBJECTDIR}/_ext/4b93847/anyRTOS.o \
 	${OBJECTDIR}/_ext/dbb3556f/adc.o \
@@ -69,6 +70,11 @@ ${CND_DISTDIR}/${CND_CONF}/anyRTOS-sample.elf: ${OBJECTFILES}
 	${MKDIR} -p ${CND_DISTDIR}/${CND_CONF}
 	${LINK.c} -o ${CND_DISTDIR}/${CND_CONF}/anyRTOS-sample.elf ${OBJECTFILES} ${LDLIBSOPTIONS} -Wl,--gc-sections
 
+${OBJECTDIR}/_ext/925292fd/defer.o: ../../anyRTOS-util/defer.c 
+	${MKDIR} -p ${OBJECTDIR}/_ext/925292fd
+	${RM} "$@.d"
+	$(COMPILE.c) -O3 -Werror -D__MSP430G2553__ -I../../anyRTOS -I../../anyRTOS-util -I./src -I../foundation -std=c99 -MMD -MP -MF "$@.d" -o ${OBJECTDIR}/_ext/925292fd/defer.o ../../anyRTOS-util/defer.c
+
 ${OBJECTDIR}/_ext/925292fd/queue.o: ../../anyRTOS-util/queue.c 
 	${MKDIR} -p ${OBJECTDIR}/_ext/925292fd
 	${RM} "$@.d"
@@ -20,12 +20,42 @@
 #ifndef _ANYRTOS_CONF_
 #define _ANYRTOS_CONF_
 
-/** Defines the number of priorities. */
+/** Defines the number of priorities. It must be less than 64. */
 #define ANYRTOS_PRIORYTIES_QTY    3
 
+/** Saves the context of threads in thread handlers with setjmp/longjmp
+  * instead of in their stacks. */
+#define ANYRTOS_LEGACY_CONTEXT    0
+
+/** Number of slots of the timer wheels. It must be a power of 2.
+  * With 0 each timer keeps its threads in a single sorted list. */
+#define ANYRTOS_TIMER_WHEEL       0
+
+/** Drives the timers in tickless mode. The timer drivers program the next 
+  * expiry instead of every tick and have to define timer_sync() and 
+  * timer_reload(). */
+#define ANYRTOS_TICKLESS          0
+
+/** The owner of a mutex inherits the priority of the threads that wait it.
+  * It is not available in basic mode. */
+#define ANYRTOS_USE_INHERITANCE   0
+
 /** Remove some features for a better performance. */
 #define ANYRTOS_BASIC_MODE        0
 
+/** In basic mode the threads keep a back pointer in the timer lists, so
+  * timer_abort() does not walk them. It costs a pointer per thread. */
+#define ANYRTOS_BASIC_BACKLINK    0
+
+/** The lists of waiting threads keep the last thread of each priority, so a
+  * thread is put without walking them. It costs a pointer per priority in
+  * each event, mutex, etc. It is not available in basic mode. */
+#define ANYRTOS_PRIOR_BUCKETS     0
+
+/** Quantum in ticks of timer_tick() for the threads of the same priority.
+  * 0 disables the time slicing. */
+#define ANYRTOS_TIME_SLICE        0
+
 /** Application uses QUEUE */
 #define ANYRTOS_USE_QUEUE         1
 
@@ -35,4 +65,41 @@
 /** Application uses SEM */
 #define ANYRTOS_USE_SEM           1
 
+/** Application uses CSEM */
+#define ANYRTOS_USE_CSEM          0
+
+/** Application uses event flag groups */
+#define ANYRTOS_USE_FLAGS         0
+
+/** Application uses deferred work. Its pool has ANYRTOS_DEFER_QTY items. */
+#define ANYRTOS_USE_DEFER         0
+#define ANYRTOS_DEFER_QTY         4
+
+/** The timer driver defines trace_stamp() with a free-running counter. The
+  * run time of ANYRTOS_STATS, the latency meter and the CPU load with
+  * ANYRTOS_IDLE_LPM need it. */
+#define ANYRTOS_STAMP             0
+
+/** Number of events of the kernel trace ring. It must be a power of 2.
+  * With 0 the trace is disabled. */
+#define ANYRTOS_TRACE             0
+
+/** Accounts the run time, switches and wakeups of each thread. */
+#define ANYRTOS_STATS             0
+
+/** Paints the stacks to measure the unused stack with 1. With 2 also checks
+  * the lowest word of the stack of the running thread in each switch. */
+#define ANYRTOS_STACK_CHECK       0
+
+/** The background thread enters in low power mode in idle_run(). */
+#define ANYRTOS_IDLE_LPM          0
+
+/** Number of windows of the CPU load history. With 0 the load is not
+  * measured. */
+#define ANYRTOS_IDLE_LOAD         0
+
+/** Number of call sites measured by the latency meter of critical sections.
+  * With 0 the latency meter and jitter_period() are disabled. */
+#define ANYRTOS_LATENCY           0
+
 #endif /* _ANYRTOS_CONF_ */
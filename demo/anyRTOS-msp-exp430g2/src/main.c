@@ -22,6 +22,7 @@
 #include <stdlib.h>
 #include "anyRTOS.h"
 #include "queue.h"
+#include "defer.h"
 #include "msp-exp430g2/board-msp-exp430g2.h"
 #include "msp-exp430g2/board-msp-exp430g2.h"
 #include "msp-exp430g2/timers.h"
@@ -56,11 +57,15 @@ enum {
     _TERM_STACK  = _MIN_STACK + 5,
     _CLOCK_STACK = _MIN_STACK,
     _QUEUE_STACK = _MIN_STACK,
+    _DEFER_STACK = _MIN_STACK,
 };
 static stack_t _led_stack[_LED_STACK];
 static stack_t _term_stack[_TERM_STACK];
 static stack_t _clock_stack[_CLOCK_STACK];
 static stack_t _queue_stack[_QUEUE_STACK];
+#if defined(ANYRTOS_USE_DEFER) && ANYRTOS_USE_DEFER
+static stack_t _defer_stack[_DEFER_STACK];
+#endif
 static thread_t _th[4];
 
 
@@ -160,12 +165,16 @@ int main( void ) {
     unsigned const threadsQty = sizeof(_schInfo) / sizeof(*_schInfo);
     for( unsigned i = 0; i < threadsQty; ++i )
         scheduler_add( &_schInfo[i] );
+#if defined(ANYRTOS_USE_DEFER) && ANYRTOS_USE_DEFER
+    /* The drivers notify out of their ISRs: */
+    defer_init( _defer_stack, sizeof(_defer_stack), 0 );
+#endif
     
     /* Run scheduler: */
     scheduler_run();
     
     /* This is the task with the lowest priority: */
-    if ( false ) LPM0; 
+    if ( ANYRTOS_IDLE_LPM || ANYRTOS_IDLE_LOAD ) for(;;) idle_run();
     else for(;;) {  
         task_enterCritical();
         board_led_toggle( BOARD_LED_GREEN );
@@ -0,0 +1,108 @@
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * timers.c is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * timers.c is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "timers.h"
+#include "src/port-linux.h"
+
+/** anyRTOS timer instance for Timer0. */
+timer_t timer0;
+
+/** Number of tasks that need to Timer0. */
+static unsigned int _timer0_Qty;
+
+#if !HAL_TIMER_SIMULATED
+
+/** Periodic ISR. */
+static void _timer0_isr( void ) {
+    if ( !_timer0_Qty ) return;
+    trace_isrEnter( PORTABLE_IRQ_TIMER );
+    bool const yield = timer_tick( &timer0 );
+    trace_isrExit( PORTABLE_IRQ_TIMER );
+    if ( yield ) task_yieldISR();
+}
+
+#endif
+
+/* Configure this module and host timer. */
+void timer_allInit( void ) {
+    _timer0_Qty = 0;
+    timer_init( &timer0 );
+#if !HAL_TIMER_SIMULATED
+    portable_irqAttach( PORTABLE_IRQ_TIMER, _timer0_isr );
+    portable_timerStart( 1000000ul / HAL_TIMER0_FREQ );
+#endif
+}
+
+/* Turn on the timer and uodate the tick. */
+void timer_on( timer_t const* timer ) {
+    if ( timer != &timer0 ) return;
+    task_enterCritical();
+    task_updateTick( timer );
+    ++_timer0_Qty;
+    task_exitCritical();
+}
+
+/* Turn off the timer. */
+void timer_off( timer_t const* timer ) {
+    if ( timer != &timer0 ) return;
+    task_enterCritical();
+    --_timer0_Qty;
+    task_exitCritical();
+}
+
+/* Gets the number of threads that need a timer. */
+unsigned int timer_status( timer_t const* timer ) {
+    return ( timer == &timer0 )? _timer0_Qty: 0;
+}
+
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+
+#if !HAL_TIMER_SIMULATED
+#error "The tickless mode needs the simulated timer in the host."
+#endif
+
+/* The simulated tick counter is only updated by timer_idle(). */
+void timer_sync( timer_t const* timer ) { (void)timer; }
+
+/* The simulated timer has not any interrupt to be programmed. */
+void timer_reload( timer_t const* timer ) { (void)timer; }
+
+#endif
+
+/* The trace is stamped in microseconds. */
+uint32_t trace_stamp( void ) { return (uint32_t)portable_clock(); }
+
+/* Waits until something happens. */
+void timer_idle( void ) {
+#if HAL_TIMER_SIMULATED && defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+    /* The clock jumps straight to the next expiry: */
+    task_enterCritical();
+    tick_t ticks;
+    if ( _timer0_Qty && timer_next( &timer0, &ticks ) && timer_advance( &timer0, ticks ) ) 
+        task_yield();
+    task_exitCritical();
+#elif HAL_TIMER_SIMULATED
+    task_enterCritical();
+    if ( _timer0_Qty && timer_tick( &timer0 ) ) task_yield();
+    task_exitCritical();
+#else
+    portable_sleep();
+#endif
+}
+
+/* ------------------------------------------------------------------------ */
@@ -0,0 +1,50 @@
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * timers.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * timers.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _TIMERS_
+#define _TIMERS_
+
+#include "anyRTOS.h"
+#include "linux-host-conf.h"
+
+/** @defgroup timers Timers
+  * This module drives the anyRTOS timers in the host. The timers are ticked
+  * by the periodic timer of the host port or, in simulated mode, by the 
+  * background thread every time it has nothing to do.
+  * @{ */ 
+
+/** Configure this module and host timer. */
+void timer_allInit( void );
+
+/** Gets the number of threads that need a timer. */
+unsigned int timer_status( timer_t const* timer );
+
+/** Waits until something happens. It has to be invoked by the background 
+  * thread in a loop. In simulated mode it ticks the timers that are on. */
+void timer_idle( void );
+
+/** anyRTOS timer instance for timer 0. */
+extern timer_t timer0;
+
+/** Convert to timer 0 ticks a time in seconds. */
+#define timer0_sec( x ) \
+    ((tick_t)(HAL_TIMER0_FREQ*(x))?(tick_t)(HAL_TIMER0_FREQ*(x)):(tick_t)1)
+
+/** @} */
+
+#endif /* _TIMERS_ */
@@ -23,6 +23,7 @@
 
 #include <msp430.h>
 #include "anyRTOS.h"
+#include "defer.h"
 
 static event_t _endOfConversion;
 static mutex_t _busy;
@@ -46,11 +47,26 @@ uint16_t adc_get( unsigned channel ) {
     return result;      
 }
 
+#if defined(ANYRTOS_USE_DEFER) && ANYRTOS_USE_DEFER
+
+/** Notifies the end of conversion out of the ISR.
+  * @param param: Not used. */
+static void _notifyEnd( void* param ) {
+    (void)param;
+    event_notify( &_endOfConversion );
+}
+
+#endif
+
 /** ADC ISR: */  
 __attribute__( ( __interrupt__( ADC10_VECTOR ) ) ) 
 static void _isr( void ) {
     ADC10CTL0 &= ~ADC10ON;
-    event_notify( &_endOfConversion );    
+#if defined(ANYRTOS_USE_DEFER) && ANYRTOS_USE_DEFER
+    if ( defer_postISR( _notifyEnd, (void*)0 ) == QUEUE_DOYIELD ) task_yieldISR();
+#else
+    if ( event_notifyISR( &_endOfConversion ) ) task_yieldISR();
+#endif
 }
 
 #endif /* HAL_HAS_ADC */
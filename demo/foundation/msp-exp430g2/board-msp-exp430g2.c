@@ -19,6 +19,7 @@
 
 #include "board-msp-exp430g2.h"
 #include "anyRTOS.h"
+#include "defer.h"
 #include <stdlib.h>
 #include <stdbool.h>
 
@@ -97,12 +98,27 @@ void board_switch_waitToReleased( void ) {
     task_exitCritical();    
 }
 
+#if defined(ANYRTOS_USE_DEFER) && ANYRTOS_USE_DEFER
+
+/** Notifies the change of the switch out of the ISR.
+  * @param param: Not used. */
+static void _notifySwitch( void* param ) {
+    (void)param;
+    event_notify( &_switch );
+}
+
+#endif
+
 /** Port 1 ISR: */  
 __attribute__(( __interrupt__( PORT1_VECTOR ) )) 
 static void _port1_isr( void ) {
     P1IE  &= ~BOARD_SWITCH_BIT;
     P1IFG &= ~BOARD_SWITCH_BIT;
-    event_notify( &_switch );
+#if defined(ANYRTOS_USE_DEFER) && ANYRTOS_USE_DEFER
+    if ( defer_postISR( _notifySwitch, (void*)0 ) == QUEUE_DOYIELD ) task_yieldISR();
+#else
+    if ( event_notifyISR( &_switch ) ) task_yieldISR();
+#endif
 }
 
 #endif 
@@ -22,6 +22,10 @@
 #define HAL_HAS_SWITCH_EVENT
 #define HAL_HAS_ADC
 
+/** Timer whose counter stamps the trace with ANYRTOS_STAMP. It is never
+  * turned off. */
+#define HAL_STAMP_TIMER1
+
 
 /** MSP430 clock source fot peripherals. */
 typedef enum hal_clkSource_e {
@@ -57,7 +61,11 @@ enum {
 
 /** configuration for uart. */
 enum {
-    HAL_SERIAL_PORT_SRC = HAL_SMCLK, /**< Clock source of uart. */
+    HAL_SERIAL_PORT_SRC          = HAL_SMCLK, /**< Clock source of uart. */
+    HAL_SERIAL_PORT_RX_SIZE      = 8,  /**< RX buffer size, a power of 2. */
+    HAL_SERIAL_PORT_TX_SIZE      = 16, /**< TX buffer size. */
+    HAL_SERIAL_PORT_TX_STAGE     = 4,  /**< Bytes moved at once to the uart. */
+    HAL_SERIAL_PORT_TX_LOW_WATER = 2,  /**< Bytes left to wake the writers. */
 };
 
 
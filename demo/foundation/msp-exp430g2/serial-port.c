@@ -23,9 +23,12 @@
 #ifdef HAL_HAS_SERIAL_PORT
 
 #include <stdlib.h>
+#include <stdarg.h>
 #include <msp430.h>
 #include "anyRTOS.h"
 #include "queue.h"
+#include "spsc.h"
+#include "defer.h"
 
 /** Get the value for UCSSEL register. */
 static unsigned int _calcUCSSEL( hal_clkSource_t clkSrc ) {
@@ -74,20 +77,27 @@ static unsigned int _calcUCA0MCTL( unsigned long freq ) {
     return 0;    
 }
 
-/** Queue for receive data. */
-static queue_t _rx;
-/** Memory for receive queue. */
-static uint8_t _rxMem[4];
+/** Ring for receive data. The RX ISR puts and a single thread gets. */
+static spsc_t _rx;
+/** Memory for receive ring. Its size must be a power of 2. */
+static uint8_t _rxMem[ HAL_SERIAL_PORT_RX_SIZE ];
 
 /** Queue for transmit data. */
 static queue_t _tx;
 /** Memory for transmit FIFO. */
-static uint8_t _txMem[4];
+static uint8_t _txMem[ HAL_SERIAL_PORT_TX_SIZE ];
+
+/** Staging buffer that the TX ISR refills from the transmit queue. */
+static struct {
+    uint8_t data[ HAL_SERIAL_PORT_TX_STAGE ];
+    size_t first, last;
+} _txStage;
 
 /** Configure hardware and driver state variables. */
 void serial_init( void ) {       
-    queue_init( &_rx, _rxMem, sizeof(_rxMem) );
+    spsc_init( &_rx, _rxMem, sizeof(_rxMem) );
     queue_init( &_tx, _txMem, sizeof(_txMem) );    
+    _txStage.first = _txStage.last = (size_t)0;
     UCA0CTL1 |= UCSWRST;  
     P1SEL  |= BIT1 | BIT2;  // P1.1 <-> RXD, P1.2 <-> TXD
     P1SEL2 |= BIT1 | BIT2;  // P1.1 <-> RXD, P1.2 <-> TXD
@@ -101,17 +111,29 @@ void serial_init( void ) {
     IE2 |= UCA0RXIE;
 }
 
-/** USCIA0 TX ISR. */
+/** Refills the TX staging buffer with a block of the transmit queue.
+  * @retval QUEUE_ERROR: The transmit queue is empty.
+  * @retval QUEUE_DOYIELD: Success, yield is suggested.
+  * @retval QUEUE_DONOTYIELD: Success, no yield is suggested. */
+static queueCode_t _refillTxStage( void ) {
+    _txStage.first = 0;
+    return queue_getBlockThdISR( &_tx, _txStage.data, sizeof(_txStage.data), 
+                                 &_txStage.last, HAL_SERIAL_PORT_TX_LOW_WATER );
+}
+
+/** USCIA0 TX ISR. The queue is only accessed when the staging buffer is 
+  * empty, so the writers are woken once per block at most. */
 __attribute__(( __interrupt__( USCIAB0TX_VECTOR ) ))
 static void _usciAB0_tx_isr( void ) {
-    uint8_t byte;
-    switch( queue_get8ThdISR( &_tx, &byte, 2 ) ) {        
+    queueCode_t code = QUEUE_DONOTYIELD;
+    if ( _txStage.first == _txStage.last ) code = _refillTxStage();
+    switch( code ) {        
         case QUEUE_DOYIELD:    
-            UCA0TXBUF = byte;
+            UCA0TXBUF = _txStage.data[ _txStage.first++ ];
             task_yieldISR(); 
             break;            
         case QUEUE_DONOTYIELD:                  
-            UCA0TXBUF = byte; 
+            UCA0TXBUF = _txStage.data[ _txStage.first++ ];
             break;            
         case QUEUE_ERROR:
             IE2 &= ~UCA0TXIE;
@@ -120,11 +142,32 @@ static void _usciAB0_tx_isr( void ) {
     
 }
 
+#if defined(ANYRTOS_USE_DEFER) && ANYRTOS_USE_DEFER
+
+/** Notifies the reader of the serial port out of the RX ISR.
+  * @param param: Not used. */
+static void _notifyRx( void* param ) {
+    (void)param;
+    spsc_notify( &_rx );
+}
+
+/** USCIA0 RX ISR. The byte is put without the kernel and the reader is 
+  * notified by the worker of deferred work. */
+__attribute__( ( __interrupt__( USCIAB0RX_VECTOR ) ))
+static void _usciAB0_rx_isr( void ) {
+    uint8_t byte = UCA0RXBUF;
+    bool const wasEmpty = spsc_isEmpty( &_rx );
+    if ( !spsc_tryPut8( &_rx, byte ) || !wasEmpty ) return;
+    if ( defer_postISR( _notifyRx, (void*)0 ) == QUEUE_DOYIELD ) task_yieldISR();
+}
+
+#else
+
 /** USCIA0 RX ISR. */
 __attribute__( ( __interrupt__( USCIAB0RX_VECTOR ) ))
 static void _usciAB0_rx_isr( void ) {
     uint8_t byte = UCA0RXBUF;
-    switch( queue_put8ISR( &_rx, byte ) ) {
+    switch( spsc_put8ISR( &_rx, byte ) ) {
         case QUEUE_DOYIELD: task_yieldISR(); break;
         case QUEUE_DONOTYIELD:                              
         case QUEUE_ERROR:
@@ -132,6 +175,8 @@ static void _usciAB0_rx_isr( void ) {
     }
 }
 
+#endif
+
 /** Wait to send a character by serial port.
   * @param ch: Character to be sent. */
 static void _put( char ch ) {
@@ -151,17 +196,19 @@ static size_t _putStrLen( char const* str ) {
     return size;
 }
 
-/** Wait to get aa received character. */
-static char _get( void ) { return queue_get8( &_rx ); }
+/** Wait to get aa received character. It does not disable the interrupts
+  * unless there is no character yet. */
+static char _get( void ) { return spsc_get8( &_rx ); }
 
 static bool _getTimeout( timer_t* timer, char* ch ) {
-    return queueTimer_get8( &_rx, timer, (uint8_t*)ch );
+    return spscTimer_get8( &_rx, timer, (uint8_t*)ch );
 }
 
 /** Wait to send end of line. */
 static void _endl( void ) { _putStr("\r\n"); }
 
-static void _backSpace( void ) { _putStr("\b \b"); }
+/** Erases the last echoed character. */
+static void _erase( void ) { serial_msg( "\b \b" ); }
 
 void _backSpaceLen( size_t len ) {
     for( unsigned i = len; i; --i ) _put('\b');
@@ -280,86 +327,73 @@ void serial_u8( uint8_t data ) {
 }
 
 /* Waits until receive a character. */
-char serial_get( void ) {
-    task_enterCritical();
-    char ch = _get();
-    task_exitCritical();
-    return ch;
-}
+char serial_get( void ) { return _get(); }
 
 /* Waits until receive a character or timeout. */
 bool serialTimer_get( timer_t* timer, char* ch ) {
-    task_enterCritical();
-    bool retVal = _getTimeout( timer, ch );
-    task_exitCritical();
-    return retVal;
+    return _getTimeout( timer, ch );
 }
 
 /* Waits until receive a string. */
 size_t serial_getStr( char* str, size_t size ) {
-    task_enterCritical();
     size_t count = (size_t)0;
     --size;
     for(;;) {
         *str = _get();
         if( *str >= ' ' ) { 
             if ( count < size ) {
-                _put( *str );
+                serial_char( *str );
                 ++str;
                 ++count;
             }
         }
         else if ( *str == '\b' ) {
             if ( count ) {
-               _backSpace();
+               _erase();
                --str;
                --count;
             }
         }
         else {
-            _endl();            
+            serial_endl();
             *str = '\0';
             break;                
         }
     }
-    task_exitCritical();
     return count;
 }
 
 /* Waits until receive a numeric string. */
 size_t serial_getNum( char* str, size_t size ) {
-    task_enterCritical();
     size_t count = (size_t)0;
     --size;
     for(;;) {
         *str = _get();
         if( ( *str >= '0' ) && ( *str <= '9') ) { 
             if ( count < size ) {
-                _put( *str );
+                serial_char( *str );
                 ++str;
                 ++count;
             }
         }
         else if ( *str == '\b' ) {
             if ( count ) {
-               _backSpace();
+               _erase();
                --str;
                --count;
             }
         }
         else if ( *str < ' ' ) {
-            _endl();            
+            serial_endl();
             *str = '\0';
             break;                
         }
     }
-    task_exitCritical();
     return count;
 }
 
 size_t serialTimer_getNum( timer_t* timer, char* str, size_t size ) {
     char* ptr = str;
-    task_enterCritical();
     size_t count = (size_t)0;
     --size;
     for(;;) {
@@ -370,28 +404,118 @@ size_t serialTimer_getNum( timer_t* timer, char* str, size_t size ) {
         }
         if( ( *str >= '0' ) && ( *str <= '9') ) { 
             if ( count < size ) {
-                _put( *str );
+                serial_char( *str );
                 ++str;
                 ++count;
             }
         }
         else if ( *str == '\b' ) {
             if ( count ) {
-               _backSpace();
+               _erase();
                --str;
                --count;
             }
         }
         else if ( *str < ' ' ) {
-            _endl();            
+            serial_endl();
             *str = '\0';
             break;                
         }
     }
-    task_exitCritical();
     return count;
 }
 
+/** Destination of the formatted writer: the free room of the TX queue. */
+typedef struct writer_s {
+    queueSpan_t span[2];
+    size_t room;
+    size_t qty;
+} writer_t;
+
+/** Writes a character if there is room.
+  * @retval true: If success.
+  * @retval false: If there is no room. */
+static bool _writeChar( writer_t* w, char ch ) {
+    if ( w->qty >= w->room ) return false;
+    queueSpan_t const* span = w->span;
+    size_t i = w->qty;
+    if ( i >= span->size ) {
+        i -= span->size;
+        ++span;
+    }
+    span->data[i] = ch;
+    ++w->qty;
+    return true;
+}
+
+/** Writes a string while there is room. */
+static bool _writeStr( writer_t* w, char const* str ) {
+    for( ; *str; ++str ) if ( !_writeChar( w, *str ) ) return false;
+    return true;
+}
+
+/** Writes an unsigned number in a base while there is room. */
+static bool _writeNum( writer_t* w, unsigned int num, unsigned int base ) {
+    char digits[ sizeof(num) * 8 ];
+    unsigned i = 0;
+    do {
+        digits[ i++ ] = _nibbleToChar( num % base );
+        num /= base;
+    } while( num );
+    while( i ) if ( !_writeChar( w, digits[ --i ] ) ) return false;
+    return true;
+}
+
+/** Writes a formatted string while there is room. */
+static bool _writeFmt( writer_t* w, char const* fmt, va_list args ) {
+    for( ; *fmt; ++fmt ) {
+        if ( *fmt != '%' ) {
+            if ( !_writeChar( w, *fmt ) ) return false;
+            continue;
+        }
+        bool done;
+        switch( *++fmt ) {
+            case 's': done = _writeStr( w, va_arg( args, char const* ) ); break;
+            case 'c': done = _writeChar( w, (char)va_arg( args, int ) ); break;
+            case 'u': done = _writeNum( w, va_arg( args, unsigned int ), 10 ); break;
+            case 'x': done = _writeNum( w, va_arg( args, unsigned int ), 16 ); break;
+            case 'd': {
+                int const num = va_arg( args, int );
+                if ( num < 0 ) {
+                    done = _writeChar( w, '-' ) && _writeNum( w, -(unsigned int)num, 10 );
+                }
+                else done = _writeNum( w, num, 10 );
+                break;
+            }
+            case '\0': return true;
+            default: done = _writeChar( w, *fmt ); break;
+        }
+        if ( !done ) return false;
+    }
+    return true;
+}
+
+/* Writes a formatted string without waiting. */
+bool serial_tryPrint( size_t* written, char const* fmt, ... ) {
+    writer_t w = { .room = 0, .qty = 0 };
+    bool retVal = false;
+    task_enterCritical();
+    /* With the interrupts disabled and no thread putting, the ISR variants
+     * can be used to write in place: */
+    if ( !mutex_isBusy( &_tx.putting ) ) {
+        w.room = queue_reserveISR( &_tx, w.span );
+        va_list args;
+        va_start( args, fmt );
+        retVal = _writeFmt( &w, fmt, args );
+        va_end( args );
+        queue_commitISR( &_tx, w.qty );
+        if ( w.qty ) IE2 |= UCA0TXIE;
+    }
+    task_exitCritical();
+    if ( written ) *written = w.qty;
+    return retVal;
+}
+
 /* This makes the user to choose an option. */
 size_t serial_option( char const* const opt[], size_t qty ) {
     task_enterCritical();   
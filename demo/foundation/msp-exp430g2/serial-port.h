@@ -100,6 +100,17 @@ size_t serial_getNum( char* str, size_t size );
   *         before a numeric string is received. */
 size_t serialTimer_getNum( timer_t* timer, char* str, size_t size );
 
+/** Writes a formatted string without waiting. It is rendered straight into
+  * the free room of the transmit buffer in a single critical section. The
+  * conversions %s, %c, %d, %u, %x and %% are supported.
+  * @param written: Destination of the quantity of characters written. It 
+  *                 can be null.
+  * @param fmt: Format string.
+  * @retval true:  The whole string is written.
+  * @retval false: The string is cut because the transmit buffer is full or
+  *                another thread is writing. */
+bool serial_tryPrint( size_t* written, char const* fmt, ... );
+
 /** This makes the user to choose an option.
   * @param opt: The list of names of options.
   * @param qty: Quantity of options.
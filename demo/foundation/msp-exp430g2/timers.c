@@ -131,6 +131,174 @@ static prescaler_t _calcPrescaler( unsigned long inputFreq, unsigned long output
     return pre;
 }
 
+#if defined(ANYRTOS_STAMP) && ANYRTOS_STAMP
+
+#if defined(HAL_STAMP_TIMER0) && defined(HAL_HAS_TIMER0)
+
+/** Registers and index of the timer that stamps the trace. */
+#define _STAMP_INDEX 0u
+#define _STAMP_R     TA0R
+#define _STAMP_CCTL  TA0CCTL0
+#define _STAMP_CCR   TA0CCR0
+#define _STAMP_TIMER timer0
+
+#elif defined(HAL_STAMP_TIMER1) && defined(HAL_HAS_TIMER1)
+
+/** Registers and index of the timer that stamps the trace. */
+#define _STAMP_INDEX 1u
+#define _STAMP_R     TA1R
+#define _STAMP_CCTL  TA1CCTL0
+#define _STAMP_CCR   TA1CCR0
+#define _STAMP_TIMER timer1
+
+#else
+#error "ANYRTOS_STAMP needs HAL_STAMP_TIMER0 or HAL_STAMP_TIMER1."
+#endif
+
+/** Counts of the stamp timer until its last tick. */
+static uint32_t _stampBase;
+
+/** Accounts the counts of the ticks of a timer for the stamps.
+  * @param index: Index of the hardware timer.
+  * @param counts: Counts of the ticks elapsed. */
+static void _stamp_add( unsigned int index, uint32_t counts ) {
+    if ( index == _STAMP_INDEX ) _stampBase += counts;
+}
+
+/** Turns on the timer that stamps the trace. It is never turned off. */
+static void _stamp_start( void ) { timer_on( &_STAMP_TIMER ); }
+
+#else
+
+/** Without ANYRTOS_STAMP the counts are not accounted. */
+static void _stamp_add( unsigned int index, uint32_t counts ) {
+    (void)index;
+    (void)counts;
+}
+
+/** Without ANYRTOS_STAMP no timer is kept on. */
+static void _stamp_start( void ) { }
+
+#endif /* ANYRTOS_STAMP */
+
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+
+/** In tickless mode the hardware timers run in continuous mode. */
+#define _TIMER_MODE MC_2
+
+/** Minimum distance in counts between the counter and a new compare value. */
+#define _TICKLESS_GUARD 16u
+
+/** State of a timer in tickless mode. The compare register is programmed for
+  * the next expiry of the anyRTOS timer instead of for each tick. */
+typedef struct {
+    timer_t* timer;                  /**< Pointer to public anyRTOS timer. */
+    unsigned int volatile* counter;  /**< Counter register. */
+    unsigned int volatile* compare;  /**< Compare register. */
+    unsigned int period;             /**< Counts per tick. */
+    unsigned int maxTicks;           /**< Maximum ticks between interrupts. */
+    unsigned int last;               /**< Counter value of the last tick. */
+} tickless_t;
+
+/** State of timer 0 and timer 1 in tickless mode. */
+static tickless_t _tickless[2];
+
+/** Initializes the state of a timer in tickless mode.
+  * @param tl: Tickless state.
+  * @param timer: Pointer to public anyRTOS timer.
+  * @param counter: Counter register.
+  * @param compare: Compare register.
+  * @param period: Counts per tick. */
+static void _tickless_init( tickless_t* tl, timer_t* timer, unsigned int volatile* counter, 
+                            unsigned int volatile* compare, unsigned int period ) {
+    tl->timer = timer;
+    tl->counter = counter;
+    tl->compare = compare;
+    tl->period = period;
+    /* Interrupts are requested at least once per half of counter overflow so
+       that the elapsed counts are always well measured: */
+    tl->maxTicks = 0x8000u / period;
+    if ( !tl->maxTicks ) tl->maxTicks = 1;
+    tl->last = 0;
+    *compare = period;
+}
+
+/** Programs the compare register for the next expiry of the anyRTOS timer.
+  * It has to be called with the interrupts disabled.
+  * @param tl: Tickless state. */
+static void _tickless_reload( tickless_t* tl ) {
+    tick_t ticks;
+    if ( !timer_next( tl->timer, &ticks ) || ticks > tl->maxTicks ) 
+        ticks = tl->maxTicks;
+    unsigned int const next = tl->last + (unsigned int)ticks * tl->period;
+    unsigned int const now = *tl->counter;
+    unsigned int const elapsed = now - tl->last;
+    if ( next - tl->last < elapsed + _TICKLESS_GUARD ) *tl->compare = now + _TICKLESS_GUARD;
+    else *tl->compare = next;
+}
+
+/** Increases the tick counter of the anyRTOS timer with the ticks elapsed
+  * since the last one. It has to be called with the interrupts disabled.
+  * @param tl: Tickless state.
+  * @retval true: If yield is suggested.
+  * @retval false: If yield is not necessary. */
+static bool _tickless_sync( tickless_t* tl ) {
+    unsigned int const ticks = ( *tl->counter - tl->last ) / tl->period;
+    if ( !ticks ) return false;
+    tl->last += ticks * tl->period;
+    _stamp_add( (unsigned int)( tl - _tickless ), (uint32_t)ticks * tl->period );
+    return timer_advance( tl->timer, ticks );
+}
+
+/** Starts the counting of a timer in tickless mode. The counter has to be 
+  * just cleared.
+  * @param tl: Tickless state. */
+static void _tickless_start( tickless_t* tl ) {
+    tl->last = 0;
+    _tickless_reload( tl );
+}
+
+/** Accounts the elapsed ticks and programs the next interrupt.
+  * @param tl: Tickless state.
+  * @retval true: If yield is suggested.
+  * @retval false: If yield is not necessary. */
+static bool _tickless_isr( tickless_t* tl ) {
+    bool const yield = _tickless_sync( tl );
+    _tickless_reload( tl );
+    return yield;
+}
+
+/** Gets the tickless state of an anyRTOS timer.
+  * @param timer: The timer handler.
+  * @retval The tickless state or null pointer if timer is unknown. */
+static tickless_t* _tickless_find( timer_t const* timer ) {
+    if ( _timer0.enabled && timer == _timer0.timer ) return &_tickless[0];
+    if ( _timer1.enabled && timer == _timer1.timer ) return &_tickless[1];
+    return (tickless_t*)0;
+}
+
+/* Updates the tick counter of a timer with the ticks elapsed since the last
+ * interrupt. It is invoked in critical section by anyRTOS, which preempts
+ * the caller if a thread with higher priority has been resumed. */
+void timer_sync( timer_t const* timer ) {
+    tickless_t* const tl = _tickless_find( timer );
+    if ( tl ) (void)_tickless_sync( tl );
+}
+
+/* Programs the next interrupt of a timer. It is invoked in critical section
+ * by anyRTOS. */
+void timer_reload( timer_t const* timer ) {
+    tickless_t* const tl = _tickless_find( timer );
+    if ( tl ) _tickless_reload( tl );
+}
+
+#else
+
+/** In periodic mode the hardware timers run in up mode. */
+#define _TIMER_MODE MC_1
+
+#endif /* ANYRTOS_TICKLESS */
+
 /** Number of tasks that need to Timer0. */
 static uint8_t _timer0_Qty;
 
@@ -140,7 +308,12 @@ static void _timer0_init( void ) {
     prescaler_t const pre = _calcPrescaler( inputFreq, _timer0.outputFreq );
     if ( pre == DIV_ERR ) exit(-1);
     TA0CCTL0 = CCIE;
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+    unsigned int const period = _calcPeriod( inputFreq, _timer0.outputFreq, pre ) + 1;
+    _tickless_init( &_tickless[0], _timer0.timer, &TA0R, &TA0CCR0, period );
+#else
     TA0CCR0 = _calcPeriod( inputFreq, _timer0.outputFreq, pre );;
+#endif
     TA0CTL = _calCtrlFlags( _timer0.clkSrc, pre );;
     _timer0_Qty = 0;
     timer_init( _timer0.timer );        
@@ -150,22 +323,35 @@ static void _timer0_init( void ) {
 static void _timer0_on( void ) { 
     task_enterCritical();
     task_updateTick( &timer0 );
-    if ( !_timer0_Qty++ ) TA0CTL |= MC_1 | TACLR;
+    if ( !_timer0_Qty++ ) {
+        TA0CTL |= _TIMER_MODE | TACLR;
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+        _tickless_start( &_tickless[0] );
+#endif
+    }
     task_exitCritical();
 }
 
 /** Turn off the timer 0. */
 static void _timer0_off( void ) {
     task_enterCritical();
-    if ( !--_timer0_Qty ) TA0CTL &= ~MC_1;
+    if ( !--_timer0_Qty ) TA0CTL &= ~_TIMER_MODE;
     task_exitCritical();
 }
 
-/** Periodic ISR. */
+/** Timer ISR. */
 __attribute__( ( __interrupt__( TIMER0_A0_VECTOR ) ) )
 static void _timerA0_isr( void ) {
     if ( !_timer0.enabled ) return;
-    if ( timer_tick( _timer0.timer ) ) task_yieldISR();
+    trace_isrEnter( TIMER0_A0_VECTOR );
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+    bool const yield = _tickless_isr( &_tickless[0] );
+#else
+    _stamp_add( 0, TA0CCR0 + 1ul );
+    bool const yield = timer_tick( _timer0.timer );
+#endif
+    trace_isrExit( TIMER0_A0_VECTOR );
+    if ( yield ) task_yieldISR();
     if ( 0 ) {
         static unsigned cntr = 1;
         if ( !--cntr ) {
@@ -184,7 +370,12 @@ static void _timer1_init( void ) {
     prescaler_t const pre = _calcPrescaler( inputFreq, _timer1.outputFreq );
     if ( pre == DIV_ERR ) exit(-1);
     TA1CCTL0 = CCIE;
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+    unsigned int const period = _calcPeriod( inputFreq, _timer1.outputFreq, pre ) + 1;
+    _tickless_init( &_tickless[1], _timer1.timer, &TA1R, &TA1CCR0, period );
+#else
     TA1CCR0 = _calcPeriod( inputFreq, _timer1.outputFreq, pre );;
+#endif
     TA1CTL = _calCtrlFlags( _timer1.clkSrc, pre );;
     _timer1_Qty = 0;
     timer_init( _timer1.timer );     
@@ -194,22 +385,35 @@ static void _timer1_init( void ) {
 static void _timer1_on( void ) { 
     task_enterCritical();
     task_updateTick( _timer1.timer );
-    if ( !_timer1_Qty++ ) TA1CTL |= MC_1 | TACLR;
+    if ( !_timer1_Qty++ ) {
+        TA1CTL |= _TIMER_MODE | TACLR;
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+        _tickless_start( &_tickless[1] );
+#endif
+    }
     task_exitCritical();
 }
 
 /** Turn off the timer 1. */
 static void _timer1_off( void ) {
     task_enterCritical();
-    if ( !--_timer1_Qty ) TA1CTL &= ~MC_1;
+    if ( !--_timer1_Qty ) TA1CTL &= ~_TIMER_MODE;
     task_exitCritical();
 }
 
-/** Periodic ISR. */
+/** Timer ISR. */
 __attribute__( ( __interrupt__( TIMER1_A0_VECTOR ) ) )
 static void _timerA1_isr( void ) {
     if ( !_timer1.enabled ) return;
-    if ( timer_tick( _timer1.timer ) ) task_yieldISR();
+    trace_isrEnter( TIMER1_A0_VECTOR );
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+    bool const yield = _tickless_isr( &_tickless[1] );
+#else
+    _stamp_add( 1, TA1CCR0 + 1ul );
+    bool const yield = timer_tick( _timer1.timer );
+#endif
+    trace_isrExit( TIMER1_A0_VECTOR );
+    if ( yield ) task_yieldISR();
     if ( 0 ) {
         static unsigned cntr = 1;
         if ( !--cntr ) {
@@ -223,7 +427,7 @@ static void _timerA1_isr( void ) {
 void timer_allInit( void ) {
     if ( _timer0.enabled ) _timer0_init();
     if ( _timer1.enabled ) _timer1_init();
-   
+    _stamp_start();
 }
 
 /* Turn on the timer and uodate the tick. */
@@ -256,4 +460,25 @@ unsigned int timer_status( timer_t const* timer ) {
     return 0;
 }
 
+#if defined(ANYRTOS_STAMP) && ANYRTOS_STAMP
+
+/* Gets the counts of the stamp timer since it was turned on. It is invoked
+ * with the interrupts disabled, so a tick not accounted yet is added. */
+uint32_t trace_stamp( void ) {
+#if defined(ANYRTOS_TICKLESS) && ANYRTOS_TICKLESS
+    return _stampBase + (unsigned int)( _STAMP_R - _tickless[_STAMP_INDEX].last );
+#else
+    uint32_t base = _stampBase;
+    unsigned int counts = _STAMP_R;
+    if ( _STAMP_CCTL & CCIFG ) {
+        /* The counter reached the period and it may have restarted: */
+        counts = _STAMP_R;
+        if ( counts != _STAMP_CCR ) base += _STAMP_CCR + 1ul;
+    }
+    return base + counts;
+#endif
+}
+
+#endif /* ANYRTOS_STAMP */
+
 /* ------------------------------------------------------------------------ */
@@ -93,7 +93,7 @@ int main( void ) {
     scheduler_run();
     
     /* This is the task with the lowest priority: */
-    LPM0; 
+    for(;;) idle_run();
     
     return 0;   
 } 
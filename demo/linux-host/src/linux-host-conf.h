@@ -0,0 +1,39 @@
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * linux-host-conf.h is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * linux-host-conf.h is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef _HAL_CFG_
+#define _HAL_CFG_
+
+/** @defgroup hal-cfg Hardware Abstraction Layer Configuration
+  * @{ */ 
+
+/** Configuration for timer0. */
+enum {
+    HAL_TIMER0_FREQ = 100, /**< Desired frequency of timer0 ticks. */
+};
+
+/** The timers are ticked by the background thread instead of the host timer.
+  * The time runs as fast as possible and it does not depend on the load
+  * of the host, which is useful to run under valgrind or debuggers. */
+#ifndef HAL_TIMER_SIMULATED
+#define HAL_TIMER_SIMULATED 0
+#endif
+
+/** @} */
+
+#endif /* _HAL_CFG_ */
@@ -0,0 +1,249 @@
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * main.c is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * main.c is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include "anyRTOS.h"
+#include "queue.h"
+#include "linux-host/timers.h"
+
+/* --------------------------------------------------- Task prototypes: --- */
+static void _led_task( void* param );
+static void _producer_task( void* param );
+static void _consumer_task( void* param );
+static void _dumpTrace( void );
+static void _printStats( void );
+static void _printStacks( void );
+static void _printLatency( void );
+
+/* -------------------------------------------------- Memory for tasks: --- */
+/* Signal handlers run in the stack of the interrupted thread so stacks in 
+ * the host have to be much greater than in a MCU. */
+enum {
+    _MIN_STACK      = 4096,
+    _LED_STACK      = _MIN_STACK,
+    _PRODUCER_STACK = _MIN_STACK,
+    _CONSUMER_STACK = _MIN_STACK,
+};
+static stack_t _led_stack[_LED_STACK];
+static stack_t _producer_stack[_PRODUCER_STACK];
+static stack_t _consumer_stack[_CONSUMER_STACK];
+static thread_t _th[3];
+
+/* ------------------------------- State and communication between task:--- */
+/** This queue is used for _producer_task() to send data to _consumer_task(). */
+static queue_t _queue;
+/** Memory space for _queue. */
+static uint8_t _queue_data[16];
+
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+/** Measures of the period of _producer_task(). */
+static jitter_t _jitter;
+#endif
+
+/** Information for adding threads to scheduler. */
+static threadInfo_t const _schInfo[] = {
+    { // Blinky led
+        .process = _led_task, 
+        .param = (void*)0, 
+        .stack = _led_stack, 
+        .size = sizeof(_led_stack),
+        .prior = 0, 
+        .th = &_th[0]
+    },
+    { // Producer
+        .process = _producer_task, 
+        .param = (void*)0, 
+        .stack = _producer_stack, 
+        .size = sizeof(_producer_stack),
+        .prior = 1, 
+        .th = &_th[1]
+    },
+    { // Consumer
+        .process = _consumer_task, 
+        .param = (void*)0, 
+        .stack = _consumer_stack, 
+        .size = sizeof(_consumer_stack),
+        .prior = 2, 
+        .th = &_th[2]
+    },
+};
+
+/* ---------------------------------------------- Functions definition: --- */
+/** Entry point of application. */
+int main( void ) {    
+    
+    /* Configures common drivers: */
+    scheduler_init();  
+    timer_allInit();
+    
+    /* Configures common objects: */
+    queue_init( &_queue, _queue_data, sizeof(_queue_data) );
+    
+    /* Create task section: */
+    unsigned const threadsQty = sizeof(_schInfo) / sizeof(*_schInfo);
+    for( unsigned i = 0; i < threadsQty; ++i )
+        scheduler_add( &_schInfo[i] );
+    
+    /* Run scheduler: */
+    scheduler_run();
+    
+    /* This is the task with the lowest priority: */
+    for(;;) idle_run();
+       
+    return 0;   
+} 
+
+/** The background thread waits the timers instead of sleeping. */
+void idle_hook( void ) { timer_idle(); }
+
+/** Prints a formatted message. The standard output is shared by threads. */
+static void _print( char const* fmt, ... ) {
+    va_list args;
+    va_start( args, fmt );
+    task_enterCritical();
+    vprintf( fmt, args );
+    fflush( stdout );
+    task_exitCritical();
+    va_end( args );
+}
+
+/** Blinking LED task. */
+thread static void _led_task( void* param ) {    
+    (void)param;
+    task_enterCritical();
+    timer_on( &timer0 );
+    for(;;) {
+        _print( "LED on  at tick %u\n", timer0.tick );
+        timer_shift( &timer0, timer0_sec(0.1) );
+        _print( "LED off at tick %u\n", timer0.tick );
+        timer_period( &timer0, timer0_sec(1.0) );        
+#if defined(ANYRTOS_IDLE_LOAD) && ANYRTOS_IDLE_LOAD
+        idle_window();
+        unsigned const load = idle_load( ANYRTOS_IDLE_LOAD );
+        _print( "CPU load %u.%u%%\n", load / 10, load % 10 );
+#endif
+    }     
+}
+
+/** Sends a numbered message by the queue periodically. */
+thread static void _producer_task( void* param ) {
+    (void)param;
+    task_enterCritical();
+    timer_on( &timer0 );
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+    jitter_init( &_jitter );
+#endif
+    for( unsigned cnt = 0;; ++cnt ) {
+        char msg[16];
+        snprintf( msg, sizeof msg, "Message %u", cnt );
+        queue_putStr( &_queue, msg );
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+        jitter_period( &_jitter, &timer0, timer0_sec(0.25) );
+#else
+        timer_period( &timer0, timer0_sec(0.25) );
+#endif
+    }
+}
+
+/** Prints the messages received by the queue and finishes the demo. */
+thread static void _consumer_task( void* param ) {
+    (void)param;
+    task_enterCritical();
+    for( unsigned cnt = 0; cnt < 10; ++cnt ) {
+        char msg[16];
+        queue_getStr( &_queue, msg );
+        _print( "Received: %s\n", msg );
+    }
+    _dumpTrace();
+    _printStats();
+    _printStacks();
+    _printLatency();
+    exit( 0 );
+}
+
+/** Writes the events of the kernel trace ring to a file. They can be decoded
+  * with tools/trace-decode.c. */
+static void _dumpTrace( void ) {
+#if defined(ANYRTOS_TRACE) && ANYRTOS_TRACE
+    static traceEvent_t events[ANYRTOS_TRACE];
+    size_t const qty = trace_read( events, ANYRTOS_TRACE );
+    FILE* file = fopen( "anyRTOS-trace.bin", "wb" );
+    if ( !file ) return;
+    fwrite( events, sizeof *events, qty, file );
+    fclose( file );
+    _print( "Trace: %u events in anyRTOS-trace.bin\n", (unsigned)qty );
+#endif
+}
+
+/** Prints the accounting of threads. The run time is in microseconds. */
+static void _printStats( void ) {
+#if defined(ANYRTOS_STATS) && ANYRTOS_STATS
+    threadStats_t stats[ 1 + sizeof _th / sizeof *_th ];
+    size_t const qty = scheduler_stats( stats, sizeof stats / sizeof *stats );
+    _print( "Prior   Run time  Voluntary  Involuntary  Wakeups\n" );
+    for( size_t i = 0; i < qty; ++i )
+        _print( "%5u %10lu %10lu %12lu %8lu\n", (unsigned)stats[i].prior,
+                (unsigned long)stats[i].runTime, (unsigned long)stats[i].voluntary,
+                (unsigned long)stats[i].involuntary, (unsigned long)stats[i].wakeups );
+#endif
+}
+
+/** Prints the bytes of the stacks that have never been used. */
+static void _printStacks( void ) {
+#if defined(ANYRTOS_STACK_CHECK) && ANYRTOS_STACK_CHECK
+    unsigned const threadsQty = sizeof(_schInfo) / sizeof(*_schInfo);
+    for( unsigned i = 0; i < threadsQty; ++i )
+        _print( "Thread %u: %lu of %lu stack bytes unused\n", i,
+                (unsigned long)scheduler_stackUnused( _schInfo[i].th ),
+                (unsigned long)_schInfo[i].size );
+#endif
+}
+
+/** Prints the sites that have disabled the interrupts and the jitter of
+  * _producer_task(). The times are in microseconds. */
+static void _printLatency( void ) {
+#if defined(ANYRTOS_LATENCY) && ANYRTOS_LATENCY
+    latencySite_t sites[ ANYRTOS_LATENCY ];
+    size_t const qty = latency_read( sites, ANYRTOS_LATENCY );
+    _print( "Site                Count    Max  Histogram\n" );
+    for( size_t i = 0; i < qty; ++i ) {
+        _print( "%-18p %6lu %6lu ", sites[i].site, (unsigned long)sites[i].count,
+                (unsigned long)sites[i].max );
+        for( unsigned j = 0; j < LATENCY_BUCKETS; ++j )
+            _print( " %u", (unsigned)sites[i].hist[j] );
+        _print( "\n" );
+    }
+    _print( "Producer: period %lu..%lu, jitter %lu, latency %lu\n",
+            (unsigned long)_jitter.minPeriod, (unsigned long)_jitter.maxPeriod,
+            (unsigned long)jitter_get( &_jitter ), (unsigned long)_jitter.maxLatency );
+#endif
+}
+
+#if defined(ANYRTOS_STACK_CHECK) && ( ANYRTOS_STACK_CHECK > 1 )
+
+/** Reports the thread that has overflowed its stack and aborts the demo. */
+void scheduler_stackOverflow( thread_t* th ) {
+    fprintf( stderr, "Stack overflow in thread %p\n", (void*)th );
+    abort();
+}
+
+#endif
+
+/* ------------------------------------------------------------------------ */
@@ -0,0 +1,102 @@
+/*
+ * Developed by Rafa Garcia <rafagarcia77@gmail.com>
+ *
+ * trace-decode.c is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * trace-decode.c is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Foobar.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/* Decodes a dump of the anyRTOS kernel trace ring. The dump is the array of
+ * records copied by trace_read(). Each record has 8 bytes in little-endian:
+ * stamp (32 bits), thread (16 bits), kind (8 bits) and arg (8 bits).
+ *
+ * Usage: trace-decode [dump-file]
+ * Without file it reads the standard input. */
+
+#include <stdio.h>
+#include <stdint.h>
+
+/* ------------------------------------------------- Trace definitions: --- */
+/* They have to match with anyRTOS/trace.h. */
+enum { _SWITCH, _BLOCK, _WAKEUP, _ISR_ENTER, _ISR_EXIT, _KINDS };
+
+static char const* const _kinds[] = {
+    "switch", "block", "wakeup", "isr-enter", "isr-exit"
+};
+
+static char const* const _reasons[] = {
+    "ready", "wait", "timer", "wait-timer", "suspend", "yield"
+};
+
+static char const* const _sources[] = {
+    "start", "notify", "timer"
+};
+
+/* ---------------------------------------------- Functions definition: --- */
+/** Gets the name of an argument or NULL if it is unknown. */
+static char const* _argName( unsigned kind, unsigned arg ) {
+    if ( kind == _BLOCK && arg < sizeof _reasons / sizeof *_reasons )
+        return _reasons[arg];
+    if ( kind == _WAKEUP && arg < sizeof _sources / sizeof *_sources )
+        return _sources[arg];
+    return NULL;
+}
+
+/** Reads little-endian words. */
+static uint32_t _le32( uint8_t const* p ) {
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+static unsigned _le16( uint8_t const* p ) { return p[0] | p[1] << 8; }
+
+int main( int argc, char* argv[] ) {
+    FILE* file = stdin;
+    if ( argc > 1 && !( file = fopen( argv[1], "rb" ) ) ) {
+        perror( argv[1] );
+        return 1;
+    }
+    uint8_t rec[8];
+    unsigned long qty = 0, switches = 0;
+    uint32_t prev = 0;
+    unsigned running = 0;
+    printf( "%10s %8s  %-5s  %-9s  %s\n", "stamp", "delta", "thread", "event", "arg" );
+    while( fread( rec, sizeof rec, 1, file ) == 1 ) {
+        uint32_t const stamp = _le32( rec );
+        unsigned const th = _le16( rec + 4 );
+        unsigned const kind = rec[6];
+        unsigned const arg = rec[7];
+        uint32_t const delta = qty ? stamp - prev : 0;
+        prev = stamp;
+        ++qty;
+        if ( kind >= _KINDS ) {
+            printf( "%10lu %8lu  T%04x  unknown %u\n", (unsigned long)stamp,
+                    (unsigned long)delta, th, kind );
+            continue;
+        }
+        printf( "%10lu %8lu  T%04x  %-9s  ", (unsigned long)stamp,
+                (unsigned long)delta, th, _kinds[kind] );
+        char const* const name = _argName( kind, arg );
+        if ( name ) printf( "%s", name );
+        else if ( kind == _ISR_ENTER || kind == _ISR_EXIT ) printf( "irq %u", arg );
+        if ( kind == _SWITCH ) {
+            if ( running && th != running ) printf( "from T%04x", running );
+            running = th;
+            ++switches;
+        }
+        putchar( '\n' );
+    }
+    if ( file != stdin ) fclose( file );
+    printf( "%lu events, %lu switches\n", qty, switches );
+    return 0;
+}
+
+/* ------------------------------------------------------------------------ */